@@ -0,0 +1,74 @@
+/// \file AABB.h
+/// \brief axis aligned bounding box, used to bound shapes when building the BVH
+/// \author Josh Bailey
+
+#ifndef _AABB_H_
+#define _AABB_H_
+
+//File includes
+#include <cmath>
+#include <glm.hpp>
+
+class AABB
+{
+public:
+	//Variables
+	glm::vec3 m_min;
+	glm::vec3 m_max;
+
+	//Functions
+	AABB()
+	{
+		//Empty box, growing it by anything gives that thing's bounds
+		m_min = glm::vec3(INFINITY, INFINITY, INFINITY);
+		m_max = glm::vec3(-INFINITY, -INFINITY, -INFINITY);
+	}
+
+	AABB(glm::vec3 _min, glm::vec3 _max)
+	{
+		m_min = _min;
+		m_max = _max;
+	}
+
+	void Grow(const glm::vec3 &_point)
+	{
+		m_min = glm::min(m_min, _point);
+		m_max = glm::max(m_max, _point);
+	}
+
+	void Grow(const AABB &_box)
+	{
+		m_min = glm::min(m_min, _box.m_min);
+		m_max = glm::max(m_max, _box.m_max);
+	}
+
+	glm::vec3 Centroid() const
+	{
+		return (m_min + m_max) * 0.5f;
+	}
+
+	float SurfaceArea() const
+	{
+		glm::vec3 extent = m_max - m_min;
+		if (extent.x < 0 || extent.y < 0 || extent.z < 0)
+		{
+			return 0.0f;
+		}
+		return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+	}
+
+	//Slab test, returns distance the ray enters the box in _tNear, direction passed as its reciprocal
+	bool Intersection(float *_tNear, const glm::vec3 &_originOfRay, const glm::vec3 &_inverseDirectionOfRay, float _maxT) const
+	{
+		glm::vec3 t0 = (m_min - _originOfRay) * _inverseDirectionOfRay;
+		glm::vec3 t1 = (m_max - _originOfRay) * _inverseDirectionOfRay;
+		glm::vec3 tSmall = glm::min(t0, t1);
+		glm::vec3 tBig = glm::max(t0, t1);
+		float tEnter = glm::max(glm::max(tSmall.x, tSmall.y), glm::max(tSmall.z, 0.0f));
+		float tExit = glm::min(glm::min(tBig.x, tBig.y), glm::min(tBig.z, _maxT));
+		*_tNear = tEnter;
+		return tEnter <= tExit;
+	}
+};
+
+#endif // _AABB_H_
\ No newline at end of file
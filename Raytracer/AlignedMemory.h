@@ -0,0 +1,51 @@
+/// \file AlignedMemory.h
+/// \brief allocation aligned to cache lines / SIMD registers, so vector loads never split a cache line
+/// \author Josh Bailey
+
+#ifndef _ALIGNEDMEMORY_H_
+#define _ALIGNEDMEMORY_H_
+
+//File includes
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+//64 bytes, one cache line and two AVX registers
+static const size_t cacheLineSize = 64;
+
+inline void *AlignedAllocate(size_t _size, size_t _alignment = cacheLineSize)
+{
+	if (_size == 0)
+	{
+		_size = _alignment;
+	}
+#ifdef _WIN32
+	void *memory = _aligned_malloc(_size, _alignment);
+#else
+	void *memory = nullptr;
+	if (posix_memalign(&memory, _alignment, _size) != 0)
+	{
+		memory = nullptr;
+	}
+#endif
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+inline void AlignedFree(void *_memory)
+{
+#ifdef _WIN32
+	_aligned_free(_memory);
+#else
+	free(_memory);
+#endif
+}
+
+#endif // _ALIGNEDMEMORY_H_
\ No newline at end of file
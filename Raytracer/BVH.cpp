@@ -0,0 +1,427 @@
+/// @file BVH.cpp
+/// @brief Builds the BVH top down, splitting each node where the binned surface area heuristic is cheapest, alone or across workers
+
+#include <algorithm>
+#include <atomic>
+
+#include "BVH.h"
+#include "TaskScheduler.h"
+
+//Build settings
+static const int numberOfBins = 16;		//Candidate split planes per axis are the boundaries between bins
+static const int maxLeafSize = 8;		//Below this the builder stops splitting once it looks expensive, not a bound: coincident centroids leave larger leaves
+static const float traversalCost = 1.0f;	//Cost of visiting a node relative to intersecting one primitive
+static const int parallelBinSize = 65536;	//Nodes this big are binned by every worker at once, smaller ones become tasks
+static const int taskSize = 4096;			//Below this a subtree is built by the task that reached it, nothing is handed off
+static const int chunksPerWorker = 4;		//Slices of a node's primitives binned in parallel, more than one each to even out
+
+//Primitive bounds and counts per bin along each axis
+struct BVHBins
+{
+	AABB m_bounds[3][numberOfBins];
+	int m_count[3][numberOfBins];
+};
+
+//Shared by every task of one build
+struct BVHBuild
+{
+	const std::vector<AABB> *m_bounds;
+	std::vector<glm::vec3> m_centroids;
+	std::atomic<int> m_usedNodes;	//Children are taken in pairs from nodes allocated up front, so no task reallocates
+	TaskScheduler *m_scheduler;		//nullptr when the calling thread builds alone
+};
+
+//Bins primitives [_first, _first + _count) by centroid along every axis the centroids are spread along
+static void Bin(const std::vector<int> &_primitives, int _first, int _count, const AABB &_centroidBounds, const BVHBuild &_build, BVHBins *_bins)
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		for (int bin = 0; bin < numberOfBins; ++bin)
+		{
+			_bins->m_bounds[axis][bin] = AABB();
+			_bins->m_count[axis][bin] = 0;
+		}
+	}
+
+	glm::vec3 extent = _centroidBounds.m_max - _centroidBounds.m_min;
+	glm::vec3 scale = glm::vec3(0, 0, 0);
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (extent[axis] > 0.0f)
+		{
+			scale[axis] = numberOfBins / extent[axis];
+		}
+	}
+
+	for (int i = _first; i < _first + _count; ++i)
+	{
+		int primitive = _primitives[i];
+		const glm::vec3 &centroid = _build.m_centroids[primitive];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (extent[axis] <= 0.0f)
+			{
+				continue;
+			}
+			int bin = std::min(numberOfBins - 1, (int)((centroid[axis] - _centroidBounds.m_min[axis]) * scale[axis]));
+			_bins->m_bounds[axis][bin].Grow((*_build.m_bounds)[primitive]);
+			++_bins->m_count[axis][bin];
+		}
+	}
+}
+
+//Bounds only grow and counts only add, so bins merged in any order are exactly the bins of one pass
+static void MergeBins(BVHBins *_into, const BVHBins &_from)
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		for (int bin = 0; bin < numberOfBins; ++bin)
+		{
+			_into->m_bounds[axis][bin].Grow(_from.m_bounds[axis][bin]);
+			_into->m_count[axis][bin] += _from.m_count[axis][bin];
+		}
+	}
+}
+
+//Cheapest plane between two bins, false if every centroid is in the same place
+static bool ChooseSplit(const BVHBins &_bins, const AABB &_centroidBounds, int *_axis, int *_split, float *_cost)
+{
+	float bestCost = INFINITY;
+	int bestAxis = -1;
+	int bestSplit = 0;
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (_centroidBounds.m_max[axis] - _centroidBounds.m_min[axis] <= 0.0f)
+		{
+			continue;
+		}
+
+		//Sweep from both ends so every split plane is costed in one pass each way
+		float leftArea[numberOfBins - 1];
+		int leftCount[numberOfBins - 1];
+		AABB sweep;
+		int sweepCount = 0;
+		for (int i = 0; i < numberOfBins - 1; ++i)
+		{
+			sweep.Grow(_bins.m_bounds[axis][i]);
+			sweepCount += _bins.m_count[axis][i];
+			leftArea[i] = sweep.SurfaceArea();
+			leftCount[i] = sweepCount;
+		}
+
+		sweep = AABB();
+		sweepCount = 0;
+		for (int i = numberOfBins - 1; i > 0; --i)
+		{
+			sweep.Grow(_bins.m_bounds[axis][i]);
+			sweepCount += _bins.m_count[axis][i];
+			float cost = leftCount[i - 1] * leftArea[i - 1] + sweepCount * sweep.SurfaceArea();
+			if (leftCount[i - 1] > 0 && sweepCount > 0 && cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = i;
+			}
+		}
+	}
+
+	*_axis = bestAxis;
+	*_split = bestSplit;
+	*_cost = bestCost;
+	return bestAxis != -1;
+}
+
+//Runs _work(first, count) over slices of [_first, _first + _count) on every worker, returns once all have finished
+template <typename Work>
+static void ParallelChunks(TaskScheduler &_scheduler, int _first, int _count, int _chunks, Work _work)
+{
+	int chunkSize = (_count + _chunks - 1) / _chunks;
+	for (int chunk = 0; chunk < _chunks; ++chunk)
+	{
+		int first = _first + chunk * chunkSize;
+		int count = std::min(chunkSize, _first + _count - first);
+		_scheduler.Submit([=] { _work(chunk, first, count); });
+	}
+	_scheduler.Wait();
+}
+
+//Copies the subtree at _from in _old to _to in _nodes, each node's children straight after those of the nodes before it
+//in depth first order, as a build on one thread lays them out
+static void Reorder(const std::vector<BVHNode> &_old, int _from, int _to, std::vector<BVHNode> &_nodes)
+{
+	if (_old[_from].m_count > 0)
+	{
+		return;
+	}
+	int oldLeft = _old[_from].m_leftOrFirst;
+	int left = (int)_nodes.size();
+	_nodes[_to].m_leftOrFirst = left;
+	_nodes.push_back(_old[oldLeft]);
+	_nodes.push_back(_old[oldLeft + 1]);
+	Reorder(_old, oldLeft, left, _nodes);
+	Reorder(_old, oldLeft + 1, left + 1, _nodes);
+}
+
+BVH::BVH()
+{
+}
+
+bool BVH::Empty() const
+{
+	return m_nodes.empty();
+}
+
+void BVH::Build(const std::vector<AABB> &_bounds)
+{
+	BVHBuild build;
+	build.m_scheduler = nullptr;
+	if (!Begin(_bounds, &build))
+	{
+		return;
+	}
+
+	Subdivide(0, 0, build);
+
+	std::vector<BVHNode>(m_nodes.begin(), m_nodes.begin() + build.m_usedNodes).swap(m_nodes);
+}
+
+void BVH::Build(const std::vector<AABB> &_bounds, TaskScheduler &_scheduler)
+{
+	//One worker gains nothing from handing work to itself
+	if (_scheduler.NumberOfWorkers() == 1)
+	{
+		Build(_bounds);
+		return;
+	}
+
+	BVHBuild build;
+	build.m_scheduler = &_scheduler;
+	if (!Begin(_bounds, &build))
+	{
+		return;
+	}
+
+	//The top of the tree is split here, each node's primitives binned by every worker at once, until the nodes left
+	//are small enough to be whole tasks. Each pair is (node, depth)
+	std::vector<std::pair<int, int>> open(1, std::make_pair(0, 0));
+	std::vector<std::pair<int, int>> subtrees;
+	int chunks = _scheduler.NumberOfWorkers() * chunksPerWorker;
+	while (!open.empty())
+	{
+		int node = open.back().first;
+		int depth = open.back().second;
+		open.pop_back();
+
+		int first = m_nodes[node].m_leftOrFirst;
+		int count = m_nodes[node].m_count;
+		if (count < parallelBinSize)
+		{
+			subtrees.push_back(std::make_pair(node, depth));
+			continue;
+		}
+		if (depth >= bvhMaxDepth)
+		{
+			continue;
+		}
+
+		std::vector<AABB> chunkCentroids(chunks);
+		ParallelChunks(_scheduler, first, count, chunks, [&](int chunk, int chunkFirst, int chunkCount)
+		{
+			for (int i = chunkFirst; i < chunkFirst + chunkCount; ++i)
+			{
+				chunkCentroids[chunk].Grow(build.m_centroids[m_primitives[i]]);
+			}
+		});
+		AABB centroidBounds;
+		for (const AABB &bounds : chunkCentroids)
+		{
+			centroidBounds.Grow(bounds);
+		}
+
+		std::vector<BVHBins> chunkBins(chunks);
+		ParallelChunks(_scheduler, first, count, chunks, [&](int chunk, int chunkFirst, int chunkCount)
+		{
+			Bin(m_primitives, chunkFirst, chunkCount, centroidBounds, build, &chunkBins[chunk]);
+		});
+		for (int chunk = 1; chunk < chunks; ++chunk)
+		{
+			MergeBins(&chunkBins[0], chunkBins[chunk]);
+		}
+
+		if (Split(node, centroidBounds, chunkBins[0], build))
+		{
+			int left = m_nodes[node].m_leftOrFirst;
+			open.push_back(std::make_pair(left + 1, depth + 1));
+			open.push_back(std::make_pair(left, depth + 1));
+		}
+	}
+
+	for (const std::pair<int, int> &subtree : subtrees)
+	{
+		int node = subtree.first;
+		int depth = subtree.second;
+		BVHBuild *shared = &build;
+		_scheduler.Submit([this, node, depth, shared] { Subdivide(node, depth, *shared); });
+	}
+	_scheduler.Wait();
+
+	//Tasks took nodes in whatever order they ran, laid out again the tree is identical to one built on one thread
+	std::vector<BVHNode> nodes;
+	nodes.reserve(build.m_usedNodes);
+	nodes.push_back(m_nodes[0]);
+	Reorder(m_nodes, 0, 0, nodes);
+	m_nodes.swap(nodes);
+}
+
+float BVH::Cost() const
+{
+	if (m_nodes.empty() || m_nodes[0].m_bounds.SurfaceArea() <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	//Expected cost of a ray through the root, each node weighted by the chance a ray through the root also hits it
+	double cost = 0.0;
+	for (const BVHNode &node : m_nodes)
+	{
+		cost += (node.m_count > 0 ? (double)node.m_count : traversalCost) * node.m_bounds.SurfaceArea();
+	}
+	return (float)(cost / m_nodes[0].m_bounds.SurfaceArea());
+}
+
+bool BVH::Begin(const std::vector<AABB> &_bounds, BVHBuild *_build)
+{
+	m_nodes.clear();
+	m_primitives.clear();
+
+	int numberOfPrimitives = (int)_bounds.size();
+	if (numberOfPrimitives == 0)
+	{
+		return false;
+	}
+
+	_build->m_bounds = &_bounds;
+	_build->m_centroids.resize(numberOfPrimitives);
+	m_primitives.resize(numberOfPrimitives);
+	for (int i = 0; i < numberOfPrimitives; ++i)
+	{
+		_build->m_centroids[i] = _bounds[i].Centroid();
+		m_primitives[i] = i;
+	}
+
+	//A binary tree with N leaves has 2N - 1 nodes, all allocated here so nodes never move while tasks fill them in
+	m_nodes.resize(2 * numberOfPrimitives);
+
+	BVHNode &root = m_nodes[0];
+	root.m_leftOrFirst = 0;
+	root.m_count = numberOfPrimitives;
+	for (int i = 0; i < numberOfPrimitives; ++i)
+	{
+		root.m_bounds.Grow(_bounds[i]);
+	}
+	_build->m_usedNodes = 1;
+	return true;
+}
+
+void BVH::Subdivide(int _node, int _depth, BVHBuild &_build)
+{
+	if (m_nodes[_node].m_count <= 1 || _depth >= bvhMaxDepth)
+	{
+		return;
+	}
+	if (!SplitHere(_node, _build))
+	{
+		return;
+	}
+
+	//A big enough right half goes to whichever worker is free, this one carries on down the left
+	int left = m_nodes[_node].m_leftOrFirst;
+	if (_build.m_scheduler != nullptr && m_nodes[left + 1].m_count >= taskSize)
+	{
+		BVHBuild *shared = &_build;
+		_build.m_scheduler->Submit([this, left, _depth, shared] { Subdivide(left + 1, _depth + 1, *shared); });
+		Subdivide(left, _depth + 1, _build);
+		return;
+	}
+	Subdivide(left, _depth + 1, _build);
+	Subdivide(left + 1, _depth + 1, _build);
+}
+
+bool BVH::SplitHere(int _node, BVHBuild &_build)
+{
+	//Bins are spread across the bounds of the centroids rather than the primitives
+	int first = m_nodes[_node].m_leftOrFirst;
+	int count = m_nodes[_node].m_count;
+	AABB centroidBounds;
+	for (int i = first; i < first + count; ++i)
+	{
+		centroidBounds.Grow(_build.m_centroids[m_primitives[i]]);
+	}
+
+	BVHBins bins;
+	Bin(m_primitives, first, count, centroidBounds, _build, &bins);
+	return Split(_node, centroidBounds, bins, _build);
+}
+
+bool BVH::Split(int _node, const AABB &_centroidBounds, const BVHBins &_bins, BVHBuild &_build)
+{
+	BVHNode &node = m_nodes[_node];
+	int first = node.m_leftOrFirst;
+	int count = node.m_count;
+
+	//Every centroid in the same place, nothing to split on
+	int bestAxis = -1;
+	int bestSplit = 0;
+	float bestCost = INFINITY;
+	if (!ChooseSplit(_bins, _centroidBounds, &bestAxis, &bestSplit, &bestCost))
+	{
+		return false;
+	}
+
+	//Stop if intersecting everything here is cheaper than descending further
+	float area = node.m_bounds.SurfaceArea();
+	float splitCost = traversalCost + (area > 0.0f ? bestCost / area : 0.0f);
+	if (count <= maxLeafSize && splitCost >= (float)count)
+	{
+		return false;
+	}
+
+	//Partition the primitive range in place around the chosen plane
+	const std::vector<AABB> &bounds = *_build.m_bounds;
+	float scale = numberOfBins / (_centroidBounds.m_max[bestAxis] - _centroidBounds.m_min[bestAxis]);
+	int middle = first;
+	for (int i = first; i < first + count; ++i)
+	{
+		int primitive = m_primitives[i];
+		int bin = std::min(numberOfBins - 1, (int)((_build.m_centroids[primitive][bestAxis] - _centroidBounds.m_min[bestAxis]) * scale));
+		if (bin < bestSplit)
+		{
+			std::swap(m_primitives[i], m_primitives[middle]);
+			++middle;
+		}
+	}
+
+	BVHNode left;
+	left.m_leftOrFirst = first;
+	left.m_count = middle - first;
+	BVHNode right;
+	right.m_leftOrFirst = middle;
+	right.m_count = first + count - middle;
+	for (int i = left.m_leftOrFirst; i < left.m_leftOrFirst + left.m_count; ++i)
+	{
+		left.m_bounds.Grow(bounds[m_primitives[i]]);
+	}
+	for (int i = right.m_leftOrFirst; i < right.m_leftOrFirst + right.m_count; ++i)
+	{
+		right.m_bounds.Grow(bounds[m_primitives[i]]);
+	}
+
+	//Node becomes interior, children are stored next to each other
+	int leftIndex = _build.m_usedNodes.fetch_add(2);
+	node.m_leftOrFirst = leftIndex;
+	node.m_count = 0;
+	m_nodes[leftIndex] = left;
+	m_nodes[leftIndex + 1] = right;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,221 @@
+/// \file BVH.h
+/// \brief bounding volume hierarchy built with a binned surface area heuristic, traversed front to back
+/// \author Josh Bailey
+
+#ifndef _BVH_H_
+#define _BVH_H_
+
+//File includes
+#include <algorithm>
+#include <vector>
+#include <glm.hpp>
+
+#include "AABB.h"
+
+class TaskScheduler;
+struct BVHBins;
+struct BVHBuild;
+
+static const int bvhMaxDepth = 64;	//Deepest a leaf can be, the traversal stacks below hold this many nodes
+
+//32 bytes, two nodes share a cache line
+struct BVHNode
+{
+	AABB m_bounds;
+	int m_leftOrFirst;	//Interior node: index of left child (right child follows it), leaf: first entry in m_primitives
+	int m_count;		//Number of primitives in a leaf, 0 for interior nodes
+};
+
+class BVH
+{
+public:
+	//Variables
+	std::vector<BVHNode> m_nodes;
+	std::vector<int> m_primitives;	//Primitive indices, reordered so each leaf owns a contiguous range
+
+	//Functions
+	BVH();
+	void Build(const std::vector<AABB> &_bounds);
+	//The same tree, node for node, with the top levels binned by every worker at once and the subtrees below them
+	//built as tasks, returns once all of them have finished. Call from outside the scheduler's workers
+	void Build(const std::vector<AABB> &_bounds, TaskScheduler &_scheduler);
+	bool Empty() const;
+	float Cost() const;		//Surface area heuristic cost of a ray through the root, in primitive intersections
+
+	//Closest hit, _intersectLeaf(first, count, _minT, _hitPrimitive) is called for each leaf the ray reaches with the
+	//leaf's range of m_primitives, it lowers _minT on a closer hit, nodes further away than _minT are skipped
+	template <typename IntersectLeaf>
+	bool Intersection(float *_minT, int *_hitPrimitive, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, IntersectLeaf _intersectLeaf) const
+	{
+		return Intersection(m_nodes.data(), (int)m_nodes.size(), _minT, _hitPrimitive, _originOfRay, _directionOfRay, _intersectLeaf);
+	}
+
+	//Any hit, _occludedLeaf(first, count) returns true if something in the leaf is hit closer than _maxT and
+	//traversal stops there, without keeping the closest hit nothing has to be re-tested or sorted by distance
+	template <typename OccludedLeaf>
+	bool Occluded(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT, OccludedLeaf _occludedLeaf) const
+	{
+		return Occluded(m_nodes.data(), (int)m_nodes.size(), _originOfRay, _directionOfRay, _maxT, _occludedLeaf);
+	}
+
+	//The same traversals over nodes stored anywhere, such as a memory mapped file, rather than in m_nodes
+	template <typename IntersectLeaf>
+	static bool Intersection(const BVHNode *_nodes, int _numberOfNodes, float *_minT, int *_hitPrimitive, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, IntersectLeaf _intersectLeaf);
+	template <typename OccludedLeaf>
+	static bool Occluded(const BVHNode *_nodes, int _numberOfNodes, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT, OccludedLeaf _occludedLeaf);
+
+private:
+	//Functions
+	bool Begin(const std::vector<AABB> &_bounds, BVHBuild *_build);	//Root over every primitive, false if there are none
+	void Subdivide(int _node, int _depth, BVHBuild &_build);
+	bool SplitHere(int _node, BVHBuild &_build);	//Bins the node's primitives, then Split
+	bool Split(int _node, const AABB &_centroidBounds, const BVHBins &_bins, BVHBuild &_build);	//False if the node stays a leaf
+};
+
+template <typename IntersectLeaf>
+bool BVH::Intersection(const BVHNode *_nodes, int _numberOfNodes, float *_minT, int *_hitPrimitive, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, IntersectLeaf _intersectLeaf)
+{
+	if (_numberOfNodes == 0)
+	{
+		return false;
+	}
+
+	glm::vec3 inverseDirectionOfRay = 1.0f / _directionOfRay;
+	bool hit = false;
+	float tNear = 0.0f;
+
+	if (!_nodes[0].m_bounds.Intersection(&tNear, _originOfRay, inverseDirectionOfRay, *_minT))
+	{
+		return false;
+	}
+
+	//Nodes still to visit, paired with the distance the ray enters them
+	int stack[bvhMaxDepth];
+	float stackT[bvhMaxDepth];
+	int stackSize = 0;
+	int node = 0;
+
+	while (true)
+	{
+		const BVHNode &current = _nodes[node];
+		if (current.m_count > 0)
+		{
+			if (_intersectLeaf(current.m_leftOrFirst, current.m_count, _minT, _hitPrimitive))
+			{
+				hit = true;
+			}
+		}
+		else
+		{
+			//Visit the nearer child first, the further one waits on the stack
+			int left = current.m_leftOrFirst;
+			int right = left + 1;
+			float tLeft = 0.0f;
+			float tRight = 0.0f;
+			bool hitLeft = _nodes[left].m_bounds.Intersection(&tLeft, _originOfRay, inverseDirectionOfRay, *_minT);
+			bool hitRight = _nodes[right].m_bounds.Intersection(&tRight, _originOfRay, inverseDirectionOfRay, *_minT);
+
+			if (hitLeft && hitRight)
+			{
+				if (tRight < tLeft)
+				{
+					std::swap(left, right);
+					std::swap(tLeft, tRight);
+				}
+				stack[stackSize] = right;
+				stackT[stackSize] = tRight;
+				++stackSize;
+				node = left;
+				continue;
+			}
+			if (hitLeft)
+			{
+				node = left;
+				continue;
+			}
+			if (hitRight)
+			{
+				node = right;
+				continue;
+			}
+		}
+
+		//Pop the next node, skipping any the ray only reaches after the closest hit found so far
+		do
+		{
+			if (stackSize == 0)
+			{
+				return hit;
+			}
+			--stackSize;
+		} while (stackT[stackSize] > *_minT);
+		node = stack[stackSize];
+	}
+}
+
+template <typename OccludedLeaf>
+bool BVH::Occluded(const BVHNode *_nodes, int _numberOfNodes, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT, OccludedLeaf _occludedLeaf)
+{
+	if (_numberOfNodes == 0)
+	{
+		return false;
+	}
+
+	glm::vec3 inverseDirectionOfRay = 1.0f / _directionOfRay;
+	float tNear = 0.0f;
+
+	if (!_nodes[0].m_bounds.Intersection(&tNear, _originOfRay, inverseDirectionOfRay, _maxT))
+	{
+		return false;
+	}
+
+	int stack[bvhMaxDepth];
+	int stackSize = 0;
+	int node = 0;
+
+	while (true)
+	{
+		const BVHNode &current = _nodes[node];
+		if (current.m_count > 0)
+		{
+			if (_occludedLeaf(current.m_leftOrFirst, current.m_count))
+			{
+				return true;
+			}
+		}
+		else
+		{
+			//Nearer child first still pays off, an occluder close to the ray origin is found sooner
+			int left = current.m_leftOrFirst;
+			int right = left + 1;
+			float tLeft = 0.0f;
+			float tRight = 0.0f;
+			bool hitLeft = _nodes[left].m_bounds.Intersection(&tLeft, _originOfRay, inverseDirectionOfRay, _maxT);
+			bool hitRight = _nodes[right].m_bounds.Intersection(&tRight, _originOfRay, inverseDirectionOfRay, _maxT);
+
+			if (hitLeft && hitRight)
+			{
+				if (tRight < tLeft)
+				{
+					std::swap(left, right);
+				}
+				stack[stackSize++] = right;
+				node = left;
+				continue;
+			}
+			if (hitLeft || hitRight)
+			{
+				node = hitLeft ? left : right;
+				continue;
+			}
+		}
+
+		if (stackSize == 0)
+		{
+			return false;
+		}
+		node = stack[--stackSize];
+	}
+}
+
+#endif // _BVH_H_
\ No newline at end of file
@@ -0,0 +1,166 @@
+/// @file Benchmark.cpp
+/// @brief Times renders with std::chrono::steady_clock (wall time, unlike clock() which sums CPU time over threads)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Renderer.h"
+
+//One line of the report
+struct BenchmarkResult
+{
+	std::string m_scene;
+	int m_primitives;
+	int m_imageWidth;
+	int m_imageHeight;
+	int m_samplesPerPixel;
+	int m_numberOfThreads;
+	double m_buildSeconds;
+	double m_renderSeconds;
+	long long m_rays;
+	double m_speedup;		//Against one thread on the same scene and resolution
+	double m_efficiency;	//Speedup divided by the number of threads
+};
+
+//Canonical workloads, kept fixed so results can be compared between commits
+static const char *benchmarkScenes[] = { "default", "particles:1000", "particles:100000" };
+static const int benchmarkResolutions[][2] = { { 800, 800 }, { 1920, 1080 }, { 3840, 2160 } };
+static const int benchmarkRepeats = 3;	//Fastest of this many runs is reported
+
+static double SecondsSince(std::chrono::steady_clock::time_point _start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+}
+
+static bool EndsWith(const std::string &_text, const std::string &_suffix)
+{
+	return _text.size() >= _suffix.size() && _text.compare(_text.size() - _suffix.size(), _suffix.size(), _suffix) == 0;
+}
+
+static void WriteCSV(std::ofstream &_file, const std::vector<BenchmarkResult> &_results)
+{
+	_file << "scene,primitives,width,height,spp,threads,build_seconds,render_seconds,rays,mrays_per_second,speedup,efficiency\n";
+	for (const BenchmarkResult &result : _results)
+	{
+		char line[512];
+		snprintf(line, sizeof(line), "%s,%d,%d,%d,%d,%d,%.6f,%.6f,%lld,%.4f,%.4f,%.4f\n",
+			result.m_scene.c_str(), result.m_primitives, result.m_imageWidth, result.m_imageHeight, result.m_samplesPerPixel,
+			result.m_numberOfThreads, result.m_buildSeconds, result.m_renderSeconds, result.m_rays,
+			result.m_rays / result.m_renderSeconds / 1e6, result.m_speedup, result.m_efficiency);
+		_file << line;
+	}
+}
+
+static void WriteJSON(std::ofstream &_file, const std::vector<BenchmarkResult> &_results)
+{
+	_file << "[\n";
+	for (size_t k = 0; k < _results.size(); ++k)
+	{
+		const BenchmarkResult &result = _results[k];
+		char line[512];
+		snprintf(line, sizeof(line), "  {\"scene\": \"%s\", \"primitives\": %d, \"width\": %d, \"height\": %d, \"spp\": %d, \"threads\": %d, "
+			"\"build_seconds\": %.6f, \"render_seconds\": %.6f, \"rays\": %lld, \"mrays_per_second\": %.4f, \"speedup\": %.4f, \"efficiency\": %.4f}%s\n",
+			result.m_scene.c_str(), result.m_primitives, result.m_imageWidth, result.m_imageHeight, result.m_samplesPerPixel,
+			result.m_numberOfThreads, result.m_buildSeconds, result.m_renderSeconds, result.m_rays,
+			result.m_rays / result.m_renderSeconds / 1e6, result.m_speedup, result.m_efficiency, k + 1 < _results.size() ? "," : "");
+		_file << line;
+	}
+	_file << "]\n";
+}
+
+int RunBenchmark(const RenderSettings &_settings, const std::string &_path)
+{
+	//1, 2, 4, ... up to the requested thread count, which is always included
+	std::vector<int> threadCounts;
+	for (int threads = 1; threads < _settings.m_numberOfThreads; threads *= 2)
+	{
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(_settings.m_numberOfThreads);
+
+	std::vector<BenchmarkResult> results;
+	Renderer renderer;
+	renderer.m_settings = _settings;
+
+	for (const char *scene : benchmarkScenes)
+	{
+		//Built with every thread, the pool is created outside the timed region as the ones rendering are
+		double buildSeconds = 0.0;
+		{
+			TaskScheduler scheduler(_settings.m_numberOfThreads);
+			std::chrono::steady_clock::time_point buildStart = std::chrono::steady_clock::now();
+			if (!renderer.LoadScene(scene, scheduler))
+			{
+				return 1;
+			}
+			buildSeconds = SecondsSince(buildStart);
+		}
+
+		for (const int *resolution : benchmarkResolutions)
+		{
+			renderer.m_settings.m_imageWidth = resolution[0];
+			renderer.m_settings.m_imageHeight = resolution[1];
+			double singleThreadSeconds = 0.0;
+
+			for (int threads : threadCounts)
+			{
+				//Pool is created outside the timed region, only rendering is measured
+				TaskScheduler scheduler(threads);
+				double bestSeconds = 0.0;
+				for (int repeat = 0; repeat < benchmarkRepeats; ++repeat)
+				{
+					std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+					renderer.Render(scheduler);
+					double seconds = SecondsSince(renderStart);
+					if (repeat == 0 || seconds < bestSeconds)
+					{
+						bestSeconds = seconds;
+					}
+				}
+				if (threads == 1)
+				{
+					singleThreadSeconds = bestSeconds;
+				}
+
+				BenchmarkResult result;
+				result.m_scene = scene;
+				result.m_primitives = renderer.m_scene.NumberOfPrimitives();
+				result.m_imageWidth = resolution[0];
+				result.m_imageHeight = resolution[1];
+				result.m_samplesPerPixel = _settings.m_samplesPerPixel;
+				result.m_numberOfThreads = threads;
+				result.m_buildSeconds = buildSeconds;
+				result.m_renderSeconds = bestSeconds;
+				result.m_rays = renderer.RaysTraced();
+				result.m_speedup = singleThreadSeconds / bestSeconds;
+				result.m_efficiency = result.m_speedup / threads;
+				results.push_back(result);
+
+				printf(" %-18s %5dx%-5d %3d thread(s) %8.3fs %9.2f Mrays/s  speedup %6.2f  efficiency %5.1f%%\n",
+					scene, resolution[0], resolution[1], threads, bestSeconds, result.m_rays / bestSeconds / 1e6,
+					result.m_speedup, 100.0 * result.m_efficiency);
+			}
+		}
+	}
+
+	std::ofstream file(_path.c_str());
+	if (!file)
+	{
+		std::cout << "Could not write " << _path << std::endl;
+		return 1;
+	}
+	if (EndsWith(_path, ".json"))
+	{
+		WriteJSON(file, results);
+	}
+	else
+	{
+		WriteCSV(file, results);
+	}
+	return 0;
+}
\ No newline at end of file
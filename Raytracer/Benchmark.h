@@ -0,0 +1,16 @@
+/// \file Benchmark.h
+/// \brief renders a fixed set of scenes, resolutions and thread counts and reports wall clock throughput and scaling
+/// \author Josh Bailey
+
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+//File includes
+#include <string>
+
+#include "RenderSettings.h"
+
+//Results go to _path as JSON if it ends in .json, CSV otherwise, returns the process exit code
+int RunBenchmark(const RenderSettings &_settings, const std::string &_path);
+
+#endif // _BENCHMARK_H_
\ No newline at end of file
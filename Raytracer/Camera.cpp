@@ -0,0 +1,42 @@
+/// @file Camera.cpp
+/// @brief Orthonormal basis worked out once, rather than for every ray
+
+#include "Camera.h"
+
+Camera::Camera()
+{
+	LookAt(glm::vec3(0, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0), 90.0f);
+}
+
+void Camera::LookAt(glm::vec3 _position, glm::vec3 _target, glm::vec3 _up, float _fieldOfView)
+{
+	m_position = _position;
+	m_target = _target;
+	m_worldUp = _up;
+	m_fieldOfView = _fieldOfView;
+
+	m_forward = glm::normalize(_target - _position);
+	m_right = glm::normalize(glm::cross(m_forward, _up));
+	m_up = glm::cross(m_right, m_forward);
+	m_scale = glm::tan(glm::radians(_fieldOfView) / 2);
+}
+
+glm::vec3 Camera::Position() const
+{
+	return m_position;
+}
+
+glm::vec3 Camera::Target() const
+{
+	return m_target;
+}
+
+glm::vec3 Camera::Up() const
+{
+	return m_worldUp;
+}
+
+float Camera::FieldOfView() const
+{
+	return m_fieldOfView;
+}
\ No newline at end of file
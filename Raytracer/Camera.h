@@ -0,0 +1,40 @@
+/// \file Camera.h
+/// \brief pinhole camera placed with a position and a point to look at, maps the view plane to world space
+/// \author Josh Bailey
+
+#ifndef _CAMERA_H_
+#define _CAMERA_H_
+
+//File includes
+#include <glm.hpp>
+
+class Camera
+{
+public:
+	//Functions
+	Camera();	//At the origin looking down -Z with a 90 degree field of view, as the original renderer
+	void LookAt(glm::vec3 _position, glm::vec3 _target, glm::vec3 _up, float _fieldOfView);	//Field of view in degrees, across the image height
+	glm::vec3 Position() const;
+	glm::vec3 Target() const;
+	glm::vec3 Up() const;
+	float FieldOfView() const;
+
+	//Point on the image plane 1 unit in front of the camera, _x and _y in [-1, 1] scaled by the aspect ratio across
+	glm::vec3 PointOnImagePlane(float _x, float _y) const
+	{
+		return m_position + m_right * (_x * m_scale) + m_up * (_y * m_scale) + m_forward;
+	}
+
+private:
+	//Variables
+	glm::vec3 m_position;
+	glm::vec3 m_target;
+	glm::vec3 m_worldUp;	//As given, m_up is made perpendicular to the view direction
+	float m_fieldOfView;
+	glm::vec3 m_right;
+	glm::vec3 m_up;
+	glm::vec3 m_forward;
+	float m_scale;			//Half the height of the image plane
+};
+
+#endif // _CAMERA_H_
\ No newline at end of file
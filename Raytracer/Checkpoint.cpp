@@ -0,0 +1,149 @@
+/// @file Checkpoint.cpp
+/// @brief Header of fixed size fields followed by the tile bitmap and the estimates as they are in memory
+
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+#include "Checkpoint.h"
+
+static const char checkpointMagic[8] = { 'R', 'T', 'C', 'K', 'P', 'T', '\0', '3' };	//Last byte is the version
+
+//Estimates are written straight from memory
+static_assert(std::is_trivially_copyable<PixelEstimate>::value, "PixelEstimate must be plain data to be checkpointed");
+
+template <typename T>
+static void WriteValue(std::ofstream &_ofs, const T &_value)
+{
+	_ofs.write((const char *)&_value, sizeof(T));
+}
+
+template <typename T>
+static bool ReadValue(std::ifstream &_ifs, T *_value)
+{
+	return (bool)_ifs.read((char *)_value, sizeof(T));
+}
+
+Checkpoint::Checkpoint()
+{
+	m_imageWidth = 0;
+	m_imageHeight = 0;
+	m_samplesPerPixel = 0;
+	m_minSamplesPerPixel = 0;
+	m_adaptiveThreshold = 0.0f;
+	m_tileSize = 0;
+	m_shadows = true;
+	m_integrator = integratorWhitted;
+	m_maxDepth = 0;
+	m_rouletteThreshold = 0.0f;
+	m_endSample = 0;
+}
+
+void Checkpoint::Describe(const RenderSettings &_settings)
+{
+	m_imageWidth = _settings.m_imageWidth;
+	m_imageHeight = _settings.m_imageHeight;
+	m_samplesPerPixel = _settings.m_samplesPerPixel;
+	m_minSamplesPerPixel = _settings.m_minSamplesPerPixel;
+	m_adaptiveThreshold = _settings.m_adaptiveThreshold;
+	m_tileSize = _settings.m_tileSize;
+	m_shadows = _settings.Shadows();
+	m_integrator = _settings.m_integrator;
+	m_maxDepth = _settings.MaxDepth();
+	m_rouletteThreshold = _settings.m_rouletteThreshold;
+	m_scene = _settings.m_scene;
+}
+
+bool Checkpoint::Matches(const RenderSettings &_settings) const
+{
+	//Threads, packets and progressive passes only change how the same samples are taken
+	Checkpoint expected;
+	expected.Describe(_settings);
+	return m_imageWidth == expected.m_imageWidth && m_imageHeight == expected.m_imageHeight &&
+		m_samplesPerPixel == expected.m_samplesPerPixel && m_minSamplesPerPixel == expected.m_minSamplesPerPixel &&
+		m_adaptiveThreshold == expected.m_adaptiveThreshold && m_tileSize == expected.m_tileSize &&
+		m_shadows == expected.m_shadows && m_integrator == expected.m_integrator && m_maxDepth == expected.m_maxDepth &&
+		m_rouletteThreshold == expected.m_rouletteThreshold && m_scene == expected.m_scene;
+}
+
+bool Checkpoint::Write(const std::string &_path) const
+{
+	std::ofstream ofs(_path.c_str(), std::ios::out | std::ios::binary);
+	if (!ofs)
+	{
+		return false;
+	}
+
+	ofs.write(checkpointMagic, sizeof(checkpointMagic));
+	WriteValue(ofs, m_imageWidth);
+	WriteValue(ofs, m_imageHeight);
+	WriteValue(ofs, m_samplesPerPixel);
+	WriteValue(ofs, m_minSamplesPerPixel);
+	WriteValue(ofs, m_adaptiveThreshold);
+	WriteValue(ofs, m_tileSize);
+	WriteValue(ofs, (int)m_shadows);
+	WriteValue(ofs, m_integrator);
+	WriteValue(ofs, m_maxDepth);
+	WriteValue(ofs, m_rouletteThreshold);
+	WriteValue(ofs, m_endSample);
+	WriteValue(ofs, (int)m_scene.size());
+	ofs.write(m_scene.data(), m_scene.size());
+	WriteValue(ofs, (int)m_tilesDone.size());
+	ofs.write(m_tilesDone.data(), m_tilesDone.size());
+	ofs.write((const char *)m_estimates.data(), m_estimates.size() * sizeof(PixelEstimate));
+
+	ofs.close();
+	return !ofs.fail();
+}
+
+bool Checkpoint::Read(const std::string &_path)
+{
+	std::ifstream ifs(_path.c_str(), std::ios::in | std::ios::binary);
+	if (!ifs)
+	{
+		std::cout << "Could not open checkpoint " << _path << std::endl;
+		return false;
+	}
+
+	char magic[sizeof(checkpointMagic)];
+	if (!ifs.read(magic, sizeof(magic)) || std::memcmp(magic, checkpointMagic, sizeof(magic)) != 0)
+	{
+		std::cout << _path << " is not a checkpoint from this version" << std::endl;
+		return false;
+	}
+
+	int shadows = 0;
+	int sceneLength = 0;
+	int numberOfTiles = 0;
+	bool valid = ReadValue(ifs, &m_imageWidth) && ReadValue(ifs, &m_imageHeight) && ReadValue(ifs, &m_samplesPerPixel) &&
+		ReadValue(ifs, &m_minSamplesPerPixel) && ReadValue(ifs, &m_adaptiveThreshold) && ReadValue(ifs, &m_tileSize) &&
+		ReadValue(ifs, &shadows) && ReadValue(ifs, &m_integrator) && ReadValue(ifs, &m_maxDepth) && ReadValue(ifs, &m_rouletteThreshold) && ReadValue(ifs, &m_endSample) && ReadValue(ifs, &sceneLength);
+	valid = valid && m_imageWidth > 0 && m_imageHeight > 0 && (long long)m_imageWidth * m_imageHeight <= INT_MAX && m_tileSize > 0 &&
+		sceneLength >= 0 && sceneLength < 65536;
+
+	//Render() carries on from this pass and indexes the tiles done by tile without checking, so a pass the schedule
+	//couldn't have reached or a flag too few is damage, even when the header matches the settings
+	valid = valid && m_endSample >= 1 && m_endSample <= m_samplesPerPixel;
+	if (valid)
+	{
+		m_shadows = shadows != 0;
+		m_scene.resize(sceneLength);
+		valid = ifs.read(&m_scene[0], sceneLength) && ReadValue(ifs, &numberOfTiles) &&
+			numberOfTiles == ((m_imageWidth + m_tileSize - 1) / m_tileSize) * ((m_imageHeight + m_tileSize - 1) / m_tileSize);
+	}
+	if (valid)
+	{
+		m_tilesDone.resize(numberOfTiles);
+		m_estimates.resize((size_t)m_imageWidth * m_imageHeight);
+		valid = ifs.read(m_tilesDone.data(), numberOfTiles) && ifs.read((char *)m_estimates.data(), m_estimates.size() * sizeof(PixelEstimate));
+	}
+
+	if (!valid)
+	{
+		std::cout << "Checkpoint " << _path << " is damaged" << std::endl;
+		return false;
+	}
+	return true;
+}
\ No newline at end of file
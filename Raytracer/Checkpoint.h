@@ -0,0 +1,43 @@
+/// \file Checkpoint.h
+/// \brief everything needed to carry on a render that was stopped, saved to and loaded from a compact binary file
+/// \author Josh Bailey
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+//File includes
+#include <string>
+#include <vector>
+
+#include "PixelEstimate.h"
+#include "RenderSettings.h"
+
+class Checkpoint
+{
+public:
+	//Variables
+	int m_imageWidth;			//Settings the samples were taken with, a render can only carry on with the same ones
+	int m_imageHeight;
+	int m_samplesPerPixel;
+	int m_minSamplesPerPixel;
+	float m_adaptiveThreshold;
+	int m_tileSize;
+	bool m_shadows;
+	int m_integrator;			//IntegratorType
+	int m_maxDepth;				//Resolved, so leaving out --depth matches giving the integrator's default
+	float m_rouletteThreshold;
+	std::string m_scene;
+	int m_endSample;						//Samples per pixel the pass in progress is taking
+	std::vector<char> m_tilesDone;			//Tiles that finished the pass in progress, row-major over the grid of tiles
+	std::vector<PixelEstimate> m_estimates;	//Running mean, variance and sample count of every pixel, the sample count is
+											//also the sampler state as the jitter comes from the pixel and sample number
+
+	//Functions
+	Checkpoint();
+	void Describe(const RenderSettings &_settings);		//Copies in the settings that have to match to resume
+	bool Matches(const RenderSettings &_settings) const;
+	bool Write(const std::string &_path) const;
+	bool Read(const std::string &_path);				//False with a message printed if the file is missing, damaged or another version
+};
+
+#endif // _CHECKPOINT_H_
\ No newline at end of file
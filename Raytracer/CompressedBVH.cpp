@@ -0,0 +1,173 @@
+/// @file CompressedBVH.cpp
+/// @brief Collapses the binary BVH into 4 wide nodes and quantises each child's bounds outwards within its parent
+
+#include <algorithm>
+#include <cmath>
+
+#include "AlignedMemory.h"
+#include "CompressedBVH.h"
+
+//Smallest step, a power of two, that reaches _highest from _lowest in 255 steps, checked with the arithmetic the
+//traversal uses so float rounding can't leave the last step short
+static int Exponent(float _lowest, float _highest)
+{
+	int exponent = -126;
+	if (_highest > _lowest)
+	{
+		std::frexp((_highest - _lowest) / 255.0f, &exponent);
+		exponent = std::max(exponent, -126);
+	}
+	while (exponent < 127 && 255.0f * CompressedBVHNode::Step(exponent) + _lowest < _highest)
+	{
+		++exponent;
+	}
+	return exponent;
+}
+
+//Steps from _origin rounded down for a lower bound and up for an upper one, until the unpacked bound is outside _bound
+static unsigned char Quantise(float _bound, float _origin, float _step, bool _upper)
+{
+	int steps = (int)(_upper ? std::ceil((_bound - _origin) / _step) : std::floor((_bound - _origin) / _step));
+	steps = std::min(std::max(steps, 0), 255);
+	if (_upper)
+	{
+		while (steps < 255 && (float)steps * _step + _origin < _bound)
+		{
+			++steps;
+		}
+	}
+	else
+	{
+		while (steps > 0 && (float)steps * _step + _origin > _bound)
+		{
+			--steps;
+		}
+	}
+	return (unsigned char)steps;
+}
+
+//Copies _bounds into slot _slot of _node, in steps of the node's frame
+static void SetBounds(CompressedBVHNode &_node, int _slot, const AABB &_bounds)
+{
+	float stepX = CompressedBVHNode::Step(_node.m_exponent[0]);
+	float stepY = CompressedBVHNode::Step(_node.m_exponent[1]);
+	float stepZ = CompressedBVHNode::Step(_node.m_exponent[2]);
+	_node.m_minX[_slot] = Quantise(_bounds.m_min.x, _node.m_origin[0], stepX, false);
+	_node.m_minY[_slot] = Quantise(_bounds.m_min.y, _node.m_origin[1], stepY, false);
+	_node.m_minZ[_slot] = Quantise(_bounds.m_min.z, _node.m_origin[2], stepZ, false);
+	_node.m_maxX[_slot] = Quantise(_bounds.m_max.x, _node.m_origin[0], stepX, true);
+	_node.m_maxY[_slot] = Quantise(_bounds.m_max.y, _node.m_origin[1], stepY, true);
+	_node.m_maxZ[_slot] = Quantise(_bounds.m_max.z, _node.m_origin[2], stepZ, true);
+	_node.m_numberOfChildren = (unsigned char)std::max((int)_node.m_numberOfChildren, _slot + 1);
+}
+
+CompressedBVH::CompressedBVH()
+{
+	m_nodes = nullptr;
+	m_numberOfNodes = 0;
+}
+
+CompressedBVH::~CompressedBVH()
+{
+	Clear();
+}
+
+void CompressedBVH::Clear()
+{
+	if (m_nodes != nullptr)
+	{
+		AlignedFree(m_nodes);
+	}
+	m_nodes = nullptr;
+	m_numberOfNodes = 0;
+}
+
+bool CompressedBVH::Empty() const
+{
+	return m_numberOfNodes == 0;
+}
+
+void CompressedBVH::Build(const BVH &_bvh)
+{
+	Clear();
+	if (_bvh.Empty())
+	{
+		return;
+	}
+
+	//Built in a vector, then copied to cache line aligned memory once the size is known
+	std::vector<CompressedBVHNode> nodes;
+	nodes.reserve(_bvh.m_nodes.size() / 2 + 1);
+	const BVHNode &root = _bvh.m_nodes[0];
+	NewNode(nodes, root.m_bounds);
+	if (root.m_count > 0)
+	{
+		SetLeaf(0, 0, root.m_bounds, root.m_leftOrFirst, root.m_count, nodes);
+	}
+	else
+	{
+		Collapse(_bvh, 0, 0, nodes);
+	}
+
+	m_numberOfNodes = (int)nodes.size();
+	m_nodes = (CompressedBVHNode *)AlignedAllocate(nodes.size() * sizeof(CompressedBVHNode));
+	std::copy(nodes.begin(), nodes.end(), m_nodes);
+}
+
+int CompressedBVH::NewNode(std::vector<CompressedBVHNode> &_nodes, const AABB &_frame)
+{
+	CompressedBVHNode node;
+	std::memset(&node, 0, sizeof(node));
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		node.m_origin[axis] = _frame.m_min[axis];
+		node.m_exponent[axis] = (signed char)Exponent(_frame.m_min[axis], _frame.m_max[axis]);
+	}
+	_nodes.push_back(node);
+	return (int)_nodes.size() - 1;
+}
+
+void CompressedBVH::Collapse(const BVH &_bvh, int _binaryNode, int _node, std::vector<CompressedBVHNode> &_nodes)
+{
+	int children[compressedBVHWidth];
+	int numberOfChildren = WideBVH::OpenChildren(_bvh, _binaryNode, compressedBVHWidth, children);
+
+	for (int k = 0; k < numberOfChildren; ++k)
+	{
+		const BVHNode &child = _bvh.m_nodes[children[k]];
+		if (child.m_count > 0)
+		{
+			SetLeaf(_node, k, child.m_bounds, child.m_leftOrFirst, child.m_count, _nodes);
+			continue;
+		}
+
+		//Indices rather than references, _nodes may grow below
+		SetBounds(_nodes[_node], k, child.m_bounds);
+		int node = NewNode(_nodes, child.m_bounds);
+		_nodes[_node].m_child[k] = node;
+		_nodes[_node].m_count[k] = 0;
+		Collapse(_bvh, children[k], node, _nodes);
+	}
+}
+
+void CompressedBVH::SetLeaf(int _node, int _slot, const AABB &_bounds, int _first, int _count, std::vector<CompressedBVHNode> &_nodes)
+{
+	SetBounds(_nodes[_node], _slot, _bounds);
+	if (_count <= compressedBVHMaxCount)
+	{
+		_nodes[_node].m_child[_slot] = _first;
+		_nodes[_node].m_count[_slot] = (unsigned short)_count;
+		return;
+	}
+
+	//Only a leaf of primitives that couldn't be split, such as many in the same place, is this big, it becomes
+	//a node of equal parts with the same bounds
+	int node = NewNode(_nodes, _bounds);
+	_nodes[_node].m_child[_slot] = node;
+	_nodes[_node].m_count[_slot] = 0;
+	int part = (_count + compressedBVHWidth - 1) / compressedBVHWidth;
+	for (int k = 0; k < compressedBVHWidth && k * part < _count; ++k)
+	{
+		SetLeaf(node, k, _bounds, _first + k * part, std::min(part, _count - k * part), _nodes);
+	}
+}
\ No newline at end of file
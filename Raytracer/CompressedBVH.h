@@ -0,0 +1,237 @@
+/// \file CompressedBVH.h
+/// \brief 4 wide BVH in 64 byte nodes, child bounds quantised to 8 bits within the node, for scenes too big for the cache
+/// \author Josh Bailey
+
+#ifndef _COMPRESSEDBVH_H_
+#define _COMPRESSEDBVH_H_
+
+//File includes
+#include <cstring>
+#include <vector>
+#include <glm.hpp>
+
+#include "BVH.h"
+#include "WideBVH.h"
+
+#if defined(SPHERESET_SSE) || defined(SPHERESET_AVX)
+#include <emmintrin.h>
+#endif
+
+static const int compressedBVHWidth = 4;
+static const int compressedBVHMaxCount = 65535;	//Largest leaf a slot holds, bigger ones are split across a node of their own
+
+//64 bytes, a cache line, a quarter of the binary nodes it stands for. Each child's bounds are whole steps from the
+//node's origin, rounded outwards so a child is never smaller than the primitives in it and no hit is missed
+struct CompressedBVHNode
+{
+	float m_origin[3];						//Lowest corner of every child
+	signed char m_exponent[3];				//A step along each axis is 2^exponent, so scaling a step count is exact
+	unsigned char m_numberOfChildren;		//Slots in use, from the first, the rest are never entered
+	unsigned char m_minX[compressedBVHWidth];
+	unsigned char m_minY[compressedBVHWidth];
+	unsigned char m_minZ[compressedBVHWidth];
+	unsigned char m_maxX[compressedBVHWidth];
+	unsigned char m_maxY[compressedBVHWidth];
+	unsigned char m_maxZ[compressedBVHWidth];
+	int m_child[compressedBVHWidth];		//Interior child: index of its node, leaf: first entry in the BVH's m_primitives
+	unsigned short m_count[compressedBVHWidth];	//Number of primitives in a leaf, 0 for interior children
+
+	//As WideBVHNode::Intersection, bounds are unpacked to floats first
+	int Intersection(float *_tNear, const glm::vec3 &_originOfRay, const glm::vec3 &_inverseDirectionOfRay, float _maxT) const;
+
+	//2^_exponent for exponents that give a normal float
+	static float Step(int _exponent)
+	{
+		int bits = (_exponent + 127) << 23;
+		float step;
+		std::memcpy(&step, &bits, sizeof(step));
+		return step;
+	}
+};
+
+class CompressedBVH
+{
+public:
+	//Variables
+	CompressedBVHNode *m_nodes;		//Cache line aligned, root first
+	int m_numberOfNodes;
+
+	//Functions
+	CompressedBVH();
+	~CompressedBVH();
+	//Leaves keep their ranges of _bvh.m_primitives, as in WideBVH
+	void Build(const BVH &_bvh);
+	void Clear();
+	bool Empty() const;
+
+	//Same leaf callbacks as BVH::Intersection and BVH::Occluded
+	template <typename IntersectLeaf>
+	bool Intersection(float *_minT, int *_hitPrimitive, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, IntersectLeaf _intersectLeaf) const;
+	template <typename OccludedLeaf>
+	bool Occluded(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT, OccludedLeaf _occludedLeaf) const;
+
+private:
+	//Non-copyable, owns its nodes
+	CompressedBVH(const CompressedBVH &);
+	CompressedBVH &operator=(const CompressedBVH &);
+
+	//Functions
+	static int NewNode(std::vector<CompressedBVHNode> &_nodes, const AABB &_frame);
+	static void Collapse(const BVH &_bvh, int _binaryNode, int _node, std::vector<CompressedBVHNode> &_nodes);
+	static void SetLeaf(int _node, int _slot, const AABB &_bounds, int _first, int _count, std::vector<CompressedBVHNode> &_nodes);
+};
+
+//Leaves too big for one slot add a few levels of their own below bvhMaxDepth, 8 covers any int count
+static const int compressedBVHStackSize = (bvhMaxDepth + 8) * (compressedBVHWidth - 1) + 1;
+
+#if defined(SPHERESET_SSE) || defined(SPHERESET_AVX)
+//Four step counts widened to floats
+static inline __m128 UnpackSteps(const unsigned char *_steps)
+{
+	int packed;
+	std::memcpy(&packed, _steps, sizeof(packed));
+	__m128i zero = _mm_setzero_si128();
+	__m128i widened = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+	return _mm_cvtepi32_ps(widened);
+}
+#endif
+
+inline int CompressedBVHNode::Intersection(float *_tNear, const glm::vec3 &_originOfRay, const glm::vec3 &_inverseDirectionOfRay, float _maxT) const
+{
+	int used = (1 << m_numberOfChildren) - 1;
+#if defined(SPHERESET_SSE) || defined(SPHERESET_AVX)
+	//steps * step + origin, the same float arithmetic the build rounded the bounds against
+	__m128 stepX = _mm_set1_ps(Step(m_exponent[0]));
+	__m128 stepY = _mm_set1_ps(Step(m_exponent[1]));
+	__m128 stepZ = _mm_set1_ps(Step(m_exponent[2]));
+	__m128 cornerX = _mm_set1_ps(m_origin[0]);
+	__m128 cornerY = _mm_set1_ps(m_origin[1]);
+	__m128 cornerZ = _mm_set1_ps(m_origin[2]);
+	__m128 minX = _mm_add_ps(_mm_mul_ps(UnpackSteps(m_minX), stepX), cornerX);
+	__m128 minY = _mm_add_ps(_mm_mul_ps(UnpackSteps(m_minY), stepY), cornerY);
+	__m128 minZ = _mm_add_ps(_mm_mul_ps(UnpackSteps(m_minZ), stepZ), cornerZ);
+	__m128 maxX = _mm_add_ps(_mm_mul_ps(UnpackSteps(m_maxX), stepX), cornerX);
+	__m128 maxY = _mm_add_ps(_mm_mul_ps(UnpackSteps(m_maxY), stepY), cornerY);
+	__m128 maxZ = _mm_add_ps(_mm_mul_ps(UnpackSteps(m_maxZ), stepZ), cornerZ);
+
+	//Then the slab test of WideBVHNode::Intersection
+	__m128 originX = _mm_set1_ps(_originOfRay.x);
+	__m128 originY = _mm_set1_ps(_originOfRay.y);
+	__m128 originZ = _mm_set1_ps(_originOfRay.z);
+	__m128 inverseX = _mm_set1_ps(_inverseDirectionOfRay.x);
+	__m128 inverseY = _mm_set1_ps(_inverseDirectionOfRay.y);
+	__m128 inverseZ = _mm_set1_ps(_inverseDirectionOfRay.z);
+	__m128 t0x = _mm_mul_ps(_mm_sub_ps(minX, originX), inverseX);
+	__m128 t1x = _mm_mul_ps(_mm_sub_ps(maxX, originX), inverseX);
+	__m128 t0y = _mm_mul_ps(_mm_sub_ps(minY, originY), inverseY);
+	__m128 t1y = _mm_mul_ps(_mm_sub_ps(maxY, originY), inverseY);
+	__m128 t0z = _mm_mul_ps(_mm_sub_ps(minZ, originZ), inverseZ);
+	__m128 t1z = _mm_mul_ps(_mm_sub_ps(maxZ, originZ), inverseZ);
+	__m128 tEnter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)), _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+	__m128 tExit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)), _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_set1_ps(_maxT)));
+	_mm_storeu_ps(_tNear, tEnter);
+	return _mm_movemask_ps(_mm_cmple_ps(tEnter, tExit)) & used;
+#else
+	glm::vec3 step = glm::vec3(Step(m_exponent[0]), Step(m_exponent[1]), Step(m_exponent[2]));
+	glm::vec3 corner = glm::vec3(m_origin[0], m_origin[1], m_origin[2]);
+	int mask = 0;
+	for (int k = 0; k < m_numberOfChildren; ++k)
+	{
+		glm::vec3 lowest = glm::vec3((float)m_minX[k], (float)m_minY[k], (float)m_minZ[k]) * step + corner;
+		glm::vec3 highest = glm::vec3((float)m_maxX[k], (float)m_maxY[k], (float)m_maxZ[k]) * step + corner;
+		if (AABB(lowest, highest).Intersection(&_tNear[k], _originOfRay, _inverseDirectionOfRay, _maxT))
+		{
+			mask |= 1 << k;
+		}
+	}
+	return mask & used;
+#endif
+}
+
+template <typename IntersectLeaf>
+bool CompressedBVH::Intersection(float *_minT, int *_hitPrimitive, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, IntersectLeaf _intersectLeaf) const
+{
+	if (m_numberOfNodes == 0)
+	{
+		return false;
+	}
+
+	glm::vec3 inverseDirectionOfRay = 1.0f / _directionOfRay;
+	bool hit = false;
+	float tNear[compressedBVHWidth];
+
+	WideBVHEntry stack[compressedBVHStackSize];
+	int stackSize = 0;
+	int node = 0;
+
+	//Same ordered traversal as WideBVH::Intersection
+	while (true)
+	{
+		int mask = m_nodes[node].Intersection(tNear, _originOfRay, inverseDirectionOfRay, *_minT);
+		WideBVH::Push(m_nodes[node], mask, tNear, stack, &stackSize);
+
+		while (true)
+		{
+			if (stackSize == 0)
+			{
+				return hit;
+			}
+			const WideBVHEntry &entry = stack[--stackSize];
+			if (entry.m_t > *_minT)
+			{
+				continue;
+			}
+			if (entry.m_count == 0)
+			{
+				node = entry.m_child;
+				break;
+			}
+			if (_intersectLeaf(entry.m_child, entry.m_count, _minT, _hitPrimitive))
+			{
+				hit = true;
+			}
+		}
+	}
+}
+
+template <typename OccludedLeaf>
+bool CompressedBVH::Occluded(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT, OccludedLeaf _occludedLeaf) const
+{
+	if (m_numberOfNodes == 0)
+	{
+		return false;
+	}
+
+	glm::vec3 inverseDirectionOfRay = 1.0f / _directionOfRay;
+	float tNear[compressedBVHWidth];
+
+	WideBVHEntry stack[compressedBVHStackSize];
+	int stackSize = 0;
+	int node = 0;
+
+	while (true)
+	{
+		int mask = m_nodes[node].Intersection(tNear, _originOfRay, inverseDirectionOfRay, _maxT);
+		WideBVH::Push(m_nodes[node], mask, tNear, stack, &stackSize);
+
+		while (true)
+		{
+			if (stackSize == 0)
+			{
+				return false;
+			}
+			const WideBVHEntry &entry = stack[--stackSize];
+			if (entry.m_count == 0)
+			{
+				node = entry.m_child;
+				break;
+			}
+			if (_occludedLeaf(entry.m_child, entry.m_count))
+			{
+				return true;
+			}
+		}
+	}
+}
+
+#endif // _COMPRESSEDBVH_H_
\ No newline at end of file
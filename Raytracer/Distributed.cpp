@@ -0,0 +1,382 @@
+/// @file Distributed.cpp
+/// @brief Length-prefixed messages in native byte order, the coordinator and its workers are expected to be the same build
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Distributed.h"
+#include "RayStack.h"
+#include "Socket.h"
+#include "TaskScheduler.h"
+
+static const char distributedMagic[8] = { 'R', 'T', 'T', 'I', 'L', 'E', '\0', '3' };	//Last byte is the protocol version
+static const int tilesPerBlock = 4;			//A coordinator tile is this many render tiles across and down
+static const int connectSeconds = 10;		//How long a worker keeps trying to reach a coordinator that hasn't started yet
+
+enum MessageType
+{
+	messageJob,		//Coordinator to worker, once: what to render
+	messageTile,	//Coordinator to worker: render this tile next
+	messageResult,	//Worker to coordinator: estimates of the tile it was given
+	messageDone		//Coordinator to worker: every tile is in, disconnect
+};
+
+//Settings that decide which samples a worker takes, a worker's own threads and packet options only change how
+struct Job
+{
+	int m_imageWidth;
+	int m_imageHeight;
+	int m_samplesPerPixel;
+	int m_minSamplesPerPixel;
+	float m_adaptiveThreshold;
+	int m_tileSize;
+	int m_shadows;
+	int m_integrator;
+	int m_maxDepth;
+	float m_rouletteThreshold;
+	int m_sceneLength;		//Followed on the wire by the scene name
+};
+
+//Rectangle of the image, in pixels
+struct Tile
+{
+	int m_index;
+	int m_startX;
+	int m_startY;
+	int m_width;
+	int m_height;
+};
+
+struct ResultHeader
+{
+	int m_index;
+	long long m_raysTraced;	//Followed by the tile's PixelEstimates row by row
+};
+
+//Tiles shared between the coordinator's connection threads
+class TileBoard
+{
+public:
+	//Variables
+	std::mutex m_lock;
+	std::vector<Tile> m_tiles;
+	std::vector<int> m_workersOnTile;	//Workers currently rendering each tile
+	std::vector<char> m_done;
+	std::deque<int> m_pending;			//Tiles nobody has been given
+	int m_remaining;
+
+	//Functions
+	//A tile nobody has, once those run out a tile still being rendered elsewhere, so a slow worker at the end of the
+	//frame can be overtaken, -1 once every tile is in
+	int Next()
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_remaining == 0)
+		{
+			return -1;
+		}
+
+		int tile = -1;
+		if (!m_pending.empty())
+		{
+			tile = m_pending.front();
+			m_pending.pop_front();
+		}
+		else
+		{
+			for (int t = 0; t < (int)m_tiles.size(); ++t)
+			{
+				if (!m_done[t] && (tile == -1 || m_workersOnTile[t] < m_workersOnTile[tile]))
+				{
+					tile = t;
+				}
+			}
+		}
+		++m_workersOnTile[tile];
+		return tile;
+	}
+
+	//The worker went away, if nobody else has the tile it goes back to the front of the queue
+	void Lost(int _tile)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		--m_workersOnTile[_tile];
+		if (!m_done[_tile] && m_workersOnTile[_tile] == 0)
+		{
+			m_pending.push_front(_tile);
+		}
+	}
+
+	//First result for a tile is kept, a copy from a worker that was overtaken is dropped
+	void Finish(int _tile, const std::vector<PixelEstimate> &_estimates, long long _raysTraced, Renderer &_renderer)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		--m_workersOnTile[_tile];
+		if (m_done[_tile])
+		{
+			return;
+		}
+		const Tile &tile = m_tiles[_tile];
+		_renderer.StoreRegion(tile.m_startX, tile.m_startY, tile.m_width, tile.m_height, _estimates.data(), _raysTraced);
+		m_done[_tile] = 1;
+		--m_remaining;
+	}
+
+	int Remaining()
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		return m_remaining;
+	}
+};
+
+template <typename T>
+static bool SendValue(Socket &_socket, const T &_value)
+{
+	return _socket.Send(&_value, sizeof(T));
+}
+
+template <typename T>
+static bool ReceiveValue(Socket &_socket, T *_value)
+{
+	return _socket.Receive(_value, sizeof(T));
+}
+
+//One thread per worker, blocking on its socket while the worker renders
+static void ServeWorker(Socket &_connection, int _worker, const std::string &_scene, TileBoard &_board, Renderer &_renderer)
+{
+	char magic[sizeof(distributedMagic)];
+	if (!_connection.Receive(magic, sizeof(magic)) || std::memcmp(magic, distributedMagic, sizeof(magic)) != 0)
+	{
+		std::cout << " Worker " << _worker << " is not a worker from this version, disconnecting" << std::endl;
+		return;
+	}
+
+	const RenderSettings &settings = _renderer.m_settings;
+	Job job;
+	job.m_imageWidth = settings.m_imageWidth;
+	job.m_imageHeight = settings.m_imageHeight;
+	job.m_samplesPerPixel = settings.m_samplesPerPixel;
+	job.m_minSamplesPerPixel = settings.m_minSamplesPerPixel;
+	job.m_adaptiveThreshold = settings.m_adaptiveThreshold;
+	job.m_tileSize = settings.m_tileSize;
+	job.m_shadows = settings.m_shadows;
+	job.m_integrator = settings.m_integrator;
+	job.m_maxDepth = settings.m_maxDepth;
+	job.m_rouletteThreshold = settings.m_rouletteThreshold;
+	job.m_sceneLength = (int)_scene.size();
+	if (!SendValue(_connection, (int)messageJob) || !SendValue(_connection, job) || !_connection.Send(_scene.data(), _scene.size()))
+	{
+		return;
+	}
+
+	std::vector<PixelEstimate> estimates;
+	int tilesRendered = 0;
+	while (true)
+	{
+		int index = _board.Next();
+		if (index == -1)
+		{
+			SendValue(_connection, (int)messageDone);
+			break;
+		}
+
+		const Tile &tile = _board.m_tiles[index];
+		estimates.resize((size_t)tile.m_width * tile.m_height);
+		int type = -1;
+		ResultHeader result;
+		bool received = SendValue(_connection, (int)messageTile) && SendValue(_connection, tile) &&
+			ReceiveValue(_connection, &type) && type == messageResult && ReceiveValue(_connection, &result) && result.m_index == index &&
+			_connection.Receive(estimates.data(), estimates.size() * sizeof(PixelEstimate));
+		if (!received)
+		{
+			//Disconnected, or the coordinator cut it off because the frame is finished
+			_board.Lost(index);
+			if (_board.Remaining() > 0)
+			{
+				std::cout << " Worker " << _worker << " lost, its tile goes to another worker" << std::endl;
+			}
+			return;
+		}
+		_board.Finish(index, estimates, result.m_raysTraced, _renderer);
+		++tilesRendered;
+	}
+
+	std::cout << " Worker " << _worker << " finished after " << tilesRendered << " tiles" << std::endl;
+}
+
+bool RunCoordinator(Renderer &_renderer, int _port)
+{
+	const RenderSettings &settings = _renderer.m_settings;
+	_renderer.BeginRender();
+
+	//Coordinator tiles line up with render tiles, so a worker splits them exactly as a single process would
+	TileBoard board;
+	int blockSize = settings.m_tileSize * tilesPerBlock;
+	for (int startY = 0; startY < settings.m_imageHeight; startY += blockSize)
+	{
+		for (int startX = 0; startX < settings.m_imageWidth; startX += blockSize)
+		{
+			Tile tile;
+			tile.m_index = (int)board.m_tiles.size();
+			tile.m_startX = startX;
+			tile.m_startY = startY;
+			tile.m_width = std::min(blockSize, settings.m_imageWidth - startX);
+			tile.m_height = std::min(blockSize, settings.m_imageHeight - startY);
+			board.m_tiles.push_back(tile);
+			board.m_pending.push_back(tile.m_index);
+		}
+	}
+	board.m_workersOnTile.assign(board.m_tiles.size(), 0);
+	board.m_done.assign(board.m_tiles.size(), 0);
+	board.m_remaining = (int)board.m_tiles.size();
+
+	Socket listener;
+	if (!listener.Listen(_port))
+	{
+		std::cout << "Could not listen on port " << _port << std::endl;
+		return false;
+	}
+
+	//Workers can join at any point until the last tile is in
+	std::vector<std::unique_ptr<Socket>> connections;
+	std::vector<std::thread> threads;
+	while (board.Remaining() > 0)
+	{
+		if (!listener.WaitForConnection(100))
+		{
+			continue;
+		}
+		std::unique_ptr<Socket> connection(new Socket(listener.Accept()));
+		if (!connection->Valid())
+		{
+			continue;
+		}
+		int worker = (int)connections.size();
+		std::cout << " Worker " << worker << " connected" << std::endl;
+		threads.emplace_back(ServeWorker, std::ref(*connection), worker, settings.m_scene, std::ref(board), std::ref(_renderer));
+		connections.push_back(std::move(connection));
+	}
+	listener.Close();
+
+	//Workers still rendering copies of finished tiles are cut off rather than waited for
+	for (size_t c = 0; c < connections.size(); ++c)
+	{
+		connections[c]->Shutdown();
+	}
+	for (size_t t = 0; t < threads.size(); ++t)
+	{
+		threads[t].join();
+	}
+	return true;
+}
+
+int RunWorker(const RenderSettings &_settings)
+{
+	size_t colon = _settings.m_worker.rfind(':');
+	if (colon == std::string::npos)
+	{
+		std::cout << "--worker needs HOST:PORT, not " << _settings.m_worker << std::endl;
+		return 1;
+	}
+	std::string host = _settings.m_worker.substr(0, colon);
+	int port = std::atoi(_settings.m_worker.c_str() + colon + 1);
+
+	//Workers are often started alongside the coordinator, so give it a moment to start listening
+	Socket connection;
+	std::chrono::steady_clock::time_point giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(connectSeconds);
+	while (!connection.Connect(host, port))
+	{
+		if (std::chrono::steady_clock::now() >= giveUp)
+		{
+			std::cout << "Could not connect to " << _settings.m_worker << std::endl;
+			return 1;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+
+	int type = -1;
+	Job job;
+	std::string scene;
+	bool received = connection.Send(distributedMagic, sizeof(distributedMagic)) && ReceiveValue(connection, &type) &&
+		type == messageJob && ReceiveValue(connection, &job) && job.m_sceneLength >= 0 && job.m_sceneLength < 65536 &&
+		job.m_imageWidth > 0 && job.m_imageHeight > 0 && (long long)job.m_imageWidth * job.m_imageHeight <= INT_MAX && job.m_tileSize > 0;
+	if (received)
+	{
+		scene.resize(job.m_sceneLength);
+		received = connection.Receive(&scene[0], scene.size());
+	}
+	if (!received)
+	{
+		std::cout << "Coordinator at " << _settings.m_worker << " did not send a job" << std::endl;
+		return 1;
+	}
+
+	Renderer renderer;
+	renderer.m_settings = _settings;
+	RenderSettings &settings = renderer.m_settings;
+	settings.m_imageWidth = job.m_imageWidth;
+	settings.m_imageHeight = job.m_imageHeight;
+	settings.m_samplesPerPixel = job.m_samplesPerPixel;
+	settings.m_minSamplesPerPixel = job.m_minSamplesPerPixel;
+	settings.m_adaptiveThreshold = job.m_adaptiveThreshold;
+	settings.m_tileSize = job.m_tileSize;
+	settings.m_shadows = job.m_shadows != 0;
+	settings.m_integrator = job.m_integrator == integratorPath ? integratorPath : integratorWhitted;
+	settings.m_maxDepth = glm::clamp(job.m_maxDepth, -1, maxRayDepth);
+	settings.m_rouletteThreshold = job.m_rouletteThreshold;
+	settings.m_scene = scene;
+	settings.m_timeLimit = 0.0f;
+	TaskScheduler scheduler(settings.m_numberOfThreads);
+	if (!renderer.LoadScene(scene, scheduler))
+	{
+		return 1;
+	}
+	std::cout << " Rendering tiles of " << scene << " for " << _settings.m_worker << " with " << settings.m_numberOfThreads << " thread(s)..." << std::endl;
+
+	renderer.BeginRender();
+	std::vector<PixelEstimate> estimates;
+	int tilesRendered = 0;
+	while (ReceiveValue(connection, &type) && type == messageTile)
+	{
+		Tile tile;
+		if (!ReceiveValue(connection, &tile))
+		{
+			break;
+		}
+
+		long long raysBefore = renderer.RaysTraced();
+		renderer.RenderRegion(scheduler, tile.m_startX, tile.m_startY, tile.m_width, tile.m_height);
+
+		estimates.clear();
+		for (int y = tile.m_startY; y < tile.m_startY + tile.m_height; ++y)
+		{
+			for (int x = tile.m_startX; x < tile.m_startX + tile.m_width; ++x)
+			{
+				estimates.push_back(renderer.Estimate(x, y));
+			}
+		}
+
+		ResultHeader result;
+		result.m_index = tile.m_index;
+		result.m_raysTraced = renderer.RaysTraced() - raysBefore;
+		if (!SendValue(connection, (int)messageResult) || !SendValue(connection, result) ||
+			!connection.Send(estimates.data(), estimates.size() * sizeof(PixelEstimate)))
+		{
+			break;
+		}
+		++tilesRendered;
+	}
+
+	//Done, or the coordinator has all it needs and hung up
+	std::cout << " Rendered " << tilesRendered << " tiles" << std::endl;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+/// \file Distributed.h
+/// \brief splits one frame across processes, a coordinator hands out tiles over TCP and workers render them
+/// \author Josh Bailey
+
+#ifndef _DISTRIBUTED_H_
+#define _DISTRIBUTED_H_
+
+//File includes
+#include "Renderer.h"
+#include "RenderSettings.h"
+
+//Waits on _port for workers, hands each one tiles of _renderer's image until every tile has come back and fills the
+//image and estimates in from them, a tile whose worker disconnects goes to another one, false if _port can't be used
+bool RunCoordinator(Renderer &_renderer, int _port);
+
+//Connects to the coordinator in _settings.m_worker, takes the scene and sampling settings from it and renders
+//tiles with _settings.m_numberOfThreads threads until told to stop, returns the process exit code
+int RunWorker(const RenderSettings &_settings);
+
+#endif // _DISTRIBUTED_H_
\ No newline at end of file
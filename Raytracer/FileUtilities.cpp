@@ -0,0 +1,38 @@
+/// @file FileUtilities.cpp
+/// @brief Plain C runtime calls, stat() is available on Windows and POSIX alike
+
+#include <cstdio>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "FileUtilities.h"
+
+bool ReplaceFile(const std::string &_partial, const std::string &_path)
+{
+	if (std::rename(_partial.c_str(), _path.c_str()) == 0)
+	{
+		return true;
+	}
+
+	//Windows won't rename over an existing file
+	std::remove(_path.c_str());
+	return std::rename(_partial.c_str(), _path.c_str()) == 0;
+}
+
+bool FileStatus(const std::string &_path, long long *_size, long long *_modified)
+{
+	struct stat status;
+	if (stat(_path.c_str(), &status) != 0)
+	{
+		return false;
+	}
+	*_size = (long long)status.st_size;
+	*_modified = (long long)status.st_mtime;
+	return true;
+}
+
+std::string DirectoryOf(const std::string &_path)
+{
+	size_t separator = _path.find_last_of("/\\");
+	return separator == std::string::npos ? std::string() : _path.substr(0, separator + 1);
+}
\ No newline at end of file
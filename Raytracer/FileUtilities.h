@@ -0,0 +1,20 @@
+/// \file FileUtilities.h
+/// \brief small file system helpers shared by everything that writes or caches files
+/// \author Josh Bailey
+
+#ifndef _FILEUTILITIES_H_
+#define _FILEUTILITIES_H_
+
+//File includes
+#include <string>
+
+//Moves a file written beside _path over it, so anything reading _path never sees half a file
+bool ReplaceFile(const std::string &_partial, const std::string &_path);
+
+//Size in bytes and last modification time, false if the file doesn't exist
+bool FileStatus(const std::string &_path, long long *_size, long long *_modified);
+
+//Directory part of _path including the trailing separator, empty for a bare file name
+std::string DirectoryOf(const std::string &_path);
+
+#endif // _FILEUTILITIES_H_
\ No newline at end of file
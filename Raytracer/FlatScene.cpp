@@ -0,0 +1,376 @@
+/// @file FlatScene.cpp
+/// @brief Flattens the shapes into per-type arrays under one BVH and intersects rays with a switch on the primitive type
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "FlatScene.h"
+
+FlatScene::FlatScene()
+{
+	m_allSpheres = true;
+	m_compactBvh = false;
+	m_bvhNodes = 0;
+	m_bvhCost = 0.0f;
+	m_mappedTriangleStart.assign(1, 0);
+}
+
+bool FlatScene::Build(const std::vector<std::shared_ptr<Shape>> &_listOfShapes, const std::vector<Material> &_materials, bool _compactBvh, TaskScheduler &_scheduler)
+{
+	m_materials = _materials;
+	m_planes.clear();
+	m_triangles.clear();
+	m_mappedMeshes.clear();
+	m_mappedTriangleStart.assign(1, 0);
+	m_unsortedSpheres.clear();
+	m_unsortedSphereMaterials.clear();
+	m_unsortedTriangles.clear();
+
+	//Each shape adds its own primitives, the only virtual calls, made once per scene
+	for (const std::shared_ptr<Shape> &shape : _listOfShapes)
+	{
+		shape->Flatten(this);
+	}
+
+	//Every index has to fit below the type in a reference: spheres are numbered by BVH slot, so the BVH's primitives
+	//count, and mapped triangles are numbered on across all the meshes, however few each file holds
+	const long long mostPrimitives = 1LL << typeShift;
+	long long numberOfMappedTriangles = 0;
+	for (const MappedMesh *mesh : m_mappedMeshes)
+	{
+		numberOfMappedTriangles += mesh->NumberOfTriangles();
+	}
+	if ((long long)m_unsortedSpheres.size() + m_unsortedTriangles.size() + m_mappedMeshes.size() >= mostPrimitives ||
+		(long long)m_planes.size() >= mostPrimitives || numberOfMappedTriangles >= mostPrimitives)
+	{
+		std::cout << "Scene has more primitives than can be numbered, at most " << mostPrimitives - 1 << " shapes of one kind, counting the triangles of every geometry file together" << std::endl;
+		return false;
+	}
+	for (const MappedMesh *mesh : m_mappedMeshes)
+	{
+		m_mappedTriangleStart.push_back(m_mappedTriangleStart.back() + mesh->NumberOfTriangles());
+	}
+
+	//Spheres, then triangles, then mapped meshes, BVH primitive p is sphere p, triangle p - numberOfSpheres or mesh
+	//p - numberOfSpheres - numberOfTriangles
+	int numberOfSpheres = (int)m_unsortedSpheres.size();
+	int numberOfTriangles = (int)m_unsortedTriangles.size();
+	int numberOfMappedMeshes = (int)m_mappedMeshes.size();
+	std::vector<AABB> bounds(numberOfSpheres + numberOfTriangles + numberOfMappedMeshes);
+	for (int k = 0; k < numberOfSpheres; ++k)
+	{
+		glm::vec3 centre = glm::vec3(m_unsortedSpheres[k]);
+		glm::vec3 extent = glm::vec3(m_unsortedSpheres[k].w);
+		bounds[k] = AABB(centre - extent, centre + extent);
+	}
+	for (int k = 0; k < numberOfTriangles; ++k)
+	{
+		const TrianglePrimitive &triangle = m_unsortedTriangles[k];
+		AABB &box = bounds[numberOfSpheres + k];
+		box.Grow(triangle.m_vertex);
+		box.Grow(triangle.m_vertex + triangle.m_edge1);
+		box.Grow(triangle.m_vertex + triangle.m_edge2);
+	}
+	for (int k = 0; k < numberOfMappedMeshes; ++k)
+	{
+		bounds[numberOfSpheres + numberOfTriangles + k] = m_mappedMeshes[k]->Bounds();
+	}
+
+	m_bvh.Build(bounds, _scheduler);
+	m_bvhNodes = (int)m_bvh.m_nodes.size();
+	m_bvhCost = m_bvh.Cost();
+	m_compactBvh = _compactBvh;
+	if (m_compactBvh)
+	{
+		//Only the primitive order is needed from the binary tree after this
+		m_wideBvh.Clear();
+		m_compressedBvh.Build(m_bvh);
+		std::vector<BVHNode>().swap(m_bvh.m_nodes);
+	}
+	else
+	{
+		m_compressedBvh.Clear();
+		m_wideBvh.Build(m_bvh);
+	}
+
+	//Lay every primitive out in leaf order, so a leaf reads one contiguous run of each array
+	m_allSpheres = numberOfTriangles == 0 && numberOfMappedMeshes == 0;
+	m_spheres.Resize((int)m_bvh.m_primitives.size());
+	m_triangles.reserve(numberOfTriangles);
+	for (int k = 0; k < (int)m_bvh.m_primitives.size(); ++k)
+	{
+		int primitive = m_bvh.m_primitives[k];
+		if (primitive < numberOfSpheres)
+		{
+			m_spheres.Set(k, glm::vec3(m_unsortedSpheres[primitive]), m_unsortedSpheres[primitive].w, m_unsortedSphereMaterials[primitive]);
+			m_bvh.m_primitives[k] = Reference(primitiveSphere, k);
+		}
+		else if (primitive < numberOfSpheres + numberOfTriangles)
+		{
+			m_bvh.m_primitives[k] = Reference(primitiveTriangle, (int)m_triangles.size());
+			m_triangles.push_back(m_unsortedTriangles[primitive - numberOfSpheres]);
+		}
+		else
+		{
+			m_bvh.m_primitives[k] = Reference(primitiveMappedMesh, primitive - numberOfSpheres - numberOfTriangles);
+		}
+	}
+
+	//Release the build copies
+	std::vector<glm::vec4>().swap(m_unsortedSpheres);
+	std::vector<int>().swap(m_unsortedSphereMaterials);
+	std::vector<TrianglePrimitive>().swap(m_unsortedTriangles);
+	return true;
+}
+
+int FlatScene::NumberOfPrimitives() const
+{
+	//A mapped mesh counts as its triangles
+	return (int)(m_bvh.m_primitives.size() - m_mappedMeshes.size() + m_planes.size()) + m_mappedTriangleStart.back();
+}
+
+void FlatScene::AddSphere(const glm::vec3 &_centre, float _radius, int _material)
+{
+	m_unsortedSpheres.push_back(glm::vec4(_centre, _radius));
+	m_unsortedSphereMaterials.push_back(_material);
+}
+
+void FlatScene::AddPlane(const glm::vec3 &_point, const glm::vec3 &_normal, int _material)
+{
+	PlanePrimitive plane;
+	plane.m_point = _point;
+	plane.m_normal = _normal;
+	plane.m_material = _material;
+	m_planes.push_back(plane);
+}
+
+void FlatScene::AddTriangle(const glm::vec3 &_v0, const glm::vec3 &_v1, const glm::vec3 &_v2, int _material)
+{
+	TrianglePrimitive triangle;
+	triangle.m_vertex = _v0;
+	triangle.m_edge1 = _v1 - _v0;
+	triangle.m_edge2 = _v2 - _v0;
+	triangle.m_material = _material;
+	m_unsortedTriangles.push_back(triangle);
+}
+
+void FlatScene::AddMappedMesh(const MappedMesh *_mesh)
+{
+	m_mappedMeshes.push_back(_mesh);	//Numbered once every mesh is in, see Build
+}
+
+bool FlatScene::Intersection(HitRecord *_hit, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const
+{
+	//Planes can't go in the BVH, they are tested one by one
+	for (int k = 0; k < (int)m_planes.size(); ++k)
+	{
+		IntersectionPlane(_hit, k, _originOfRay, _directionOfRay);
+	}
+
+	//Everything else through the BVH, which only visits nodes nearer than the closest hit so far
+	auto intersectLeaf = [&](int first, int count, float *leafMinT, int *leafHitPrimitive)
+	{
+		//Fast path, every sphere in the leaf in one or two SIMD tests
+		bool hitLeaf = false;
+		int slot = -1;
+		if (m_spheres.Intersection(leafMinT, &slot, _originOfRay, _directionOfRay, first, count, *leafMinT))
+		{
+			*leafHitPrimitive = Reference(primitiveSphere, slot);
+			_hit->m_uv = glm::vec2(0, 0);
+			hitLeaf = true;
+		}
+		if (m_allSpheres)
+		{
+			return hitLeaf;
+		}
+
+		//Then the triangles and meshes sharing the leaf, leafMinT is _hit->m_t so they see the sphere hit too
+		for (int k = first; k < first + count; ++k)
+		{
+			int reference = m_bvh.m_primitives[k];
+			if (Type(reference) == primitiveTriangle && IntersectionTriangle(_hit, Index(reference), _originOfRay, _directionOfRay))
+			{
+				hitLeaf = true;
+			}
+			else if (Type(reference) == primitiveMappedMesh && IntersectionMappedMesh(_hit, Index(reference), _originOfRay, _directionOfRay))
+			{
+				hitLeaf = true;
+			}
+		}
+		return hitLeaf;
+	};
+	if (m_compactBvh)
+	{
+		m_compressedBvh.Intersection(&_hit->m_t, &_hit->m_primitive, _originOfRay, _directionOfRay, intersectLeaf);
+	}
+	else
+	{
+		m_wideBvh.Intersection(&_hit->m_t, &_hit->m_primitive, _originOfRay, _directionOfRay, intersectLeaf);
+	}
+
+	return _hit->Hit();
+}
+
+bool FlatScene::Occluded(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT) const
+{
+	//Any hit will do, so stop at the first primitive between the point and the light
+	for (int k = 0; k < (int)m_planes.size(); ++k)
+	{
+		HitRecord hit;
+		hit.m_t = _maxT;
+		if (IntersectionPlane(&hit, k, _originOfRay, _directionOfRay))
+		{
+			return true;
+		}
+	}
+
+	auto occludedLeaf = [&](int first, int count)
+	{
+		if (m_spheres.Occluded(_originOfRay, _directionOfRay, first, count, _maxT))
+		{
+			return true;
+		}
+		if (m_allSpheres)
+		{
+			return false;
+		}
+		for (int k = first; k < first + count; ++k)
+		{
+			int reference = m_bvh.m_primitives[k];
+			HitRecord hit;
+			hit.m_t = _maxT;
+			if (Type(reference) == primitiveTriangle && IntersectionTriangle(&hit, Index(reference), _originOfRay, _directionOfRay))
+			{
+				return true;
+			}
+			if (Type(reference) == primitiveMappedMesh && m_mappedMeshes[Index(reference)]->AnyHit(_originOfRay, _directionOfRay, _maxT))
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	if (m_compactBvh)
+	{
+		return m_compressedBvh.Occluded(_originOfRay, _directionOfRay, _maxT, occludedLeaf);
+	}
+	return m_wideBvh.Occluded(_originOfRay, _directionOfRay, _maxT, occludedLeaf);
+}
+
+bool FlatScene::IntersectionPlane(HitRecord *_hit, int _plane, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const
+{
+	//Plane intersection method - https://www.scratchapixel.com/lessons/3d-basic-rendering/minimal-ray-tracer-rendering-simple-shapes/ray-plane-and-ray-disk-intersection
+	const PlanePrimitive &plane = m_planes[_plane];
+	float denom = glm::dot(_directionOfRay, plane.m_normal);
+	if (std::abs(denom) < 1e-6)
+	{
+		return false;
+	}
+
+	float t = glm::dot((plane.m_point - _originOfRay), plane.m_normal) / denom;
+	if (t < 0 || t >= _hit->m_t)
+	{
+		return false;
+	}
+	_hit->m_t = t;
+	_hit->m_primitive = Reference(primitivePlane, _plane);
+	_hit->m_uv = glm::vec2(0, 0);
+	return true;
+}
+
+bool FlatScene::IntersectionTriangle(HitRecord *_hit, int _triangle, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const
+{
+	//Moller-Trumbore - https://www.scratchapixel.com/lessons/3d-basic-rendering/ray-tracing-rendering-a-triangle/moller-trumbore-ray-triangle-intersection
+	//with the edges already worked out (glm::intersectRayTriangle rejects determinants below a fixed epsilon, which loses
+	//the tiny triangles of dense meshes)
+	const TrianglePrimitive &triangle = m_triangles[_triangle];
+	glm::vec3 p = glm::cross(_directionOfRay, triangle.m_edge2);
+	float determinant = glm::dot(triangle.m_edge1, p);
+	if (determinant == 0.0f)
+	{
+		return false;
+	}
+	float inverseDeterminant = 1.0f / determinant;
+
+	glm::vec3 toOrigin = _originOfRay - triangle.m_vertex;
+	float u = glm::dot(toOrigin, p) * inverseDeterminant;
+	if (u < 0.0f || u > 1.0f)
+	{
+		return false;
+	}
+
+	glm::vec3 q = glm::cross(toOrigin, triangle.m_edge1);
+	float v = glm::dot(_directionOfRay, q) * inverseDeterminant;
+	if (v < 0.0f || u + v > 1.0f)
+	{
+		return false;
+	}
+
+	float t = glm::dot(triangle.m_edge2, q) * inverseDeterminant;
+	if (t < 0.0f || t >= _hit->m_t)
+	{
+		return false;
+	}
+	_hit->m_t = t;
+	_hit->m_primitive = Reference(primitiveTriangle, _triangle);
+	_hit->m_uv = glm::vec2(u, v);
+	return true;
+}
+
+bool FlatScene::IntersectionMappedMesh(HitRecord *_hit, int _mesh, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const
+{
+	float t = _hit->m_t;
+	int triangle = -1;
+	glm::vec2 uv = glm::vec2(0, 0);
+	if (!m_mappedMeshes[_mesh]->ClosestHit(&t, &triangle, &uv, _originOfRay, _directionOfRay))
+	{
+		return false;
+	}
+	_hit->m_t = t;
+	_hit->m_primitive = Reference(primitiveMappedTriangle, m_mappedTriangleStart[_mesh] + triangle);
+	_hit->m_uv = uv;
+	return true;
+}
+
+int FlatScene::MappedMeshOf(int _triangle) const
+{
+	//Only looked up when shading, a handful of meshes at most
+	return (int)(std::upper_bound(m_mappedTriangleStart.begin(), m_mappedTriangleStart.end(), _triangle) - m_mappedTriangleStart.begin()) - 1;
+}
+
+glm::vec3 FlatScene::Normal(const HitRecord &_hit, const glm::vec3 &_p0) const
+{
+	int index = Index(_hit.m_primitive);
+	switch (Type(_hit.m_primitive))
+	{
+	case primitiveSphere:
+		return _p0 - glm::vec3(m_spheres.m_centreX[index], m_spheres.m_centreY[index], m_spheres.m_centreZ[index]);
+	case primitivePlane:
+		return m_planes[index].m_normal;
+	case primitiveMappedTriangle:
+	{
+		int mesh = MappedMeshOf(index);
+		return m_mappedMeshes[mesh]->FaceNormal(index - m_mappedTriangleStart[mesh]);
+	}
+	default:
+		//Flat shaded, counter-clockwise winding faces outwards
+		return glm::cross(m_triangles[index].m_edge1, m_triangles[index].m_edge2);
+	}
+}
+
+const Material &FlatScene::MaterialOf(const HitRecord &_hit) const
+{
+	int index = Index(_hit.m_primitive);
+	switch (Type(_hit.m_primitive))
+	{
+	case primitiveSphere:
+		return m_materials[m_spheres.m_material[index]];
+	case primitivePlane:
+		return m_materials[m_planes[index].m_material];
+	case primitiveMappedTriangle:
+		return m_materials[m_mappedMeshes[MappedMeshOf(index)]->m_material];
+	default:
+		return m_materials[m_triangles[index].m_material];
+	}
+}
\ No newline at end of file
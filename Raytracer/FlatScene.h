@@ -0,0 +1,123 @@
+/// \file FlatScene.h
+/// \brief the scene flattened into contiguous arrays of plain primitives, what every ray actually traverses
+/// \author Josh Bailey
+
+#ifndef _FLATSCENE_H_
+#define _FLATSCENE_H_
+
+//File includes
+#include <memory>
+#include <vector>
+#include <glm.hpp>
+
+#include "BVH.h"
+#include "CompressedBVH.h"
+#include "HitRecord.h"
+#include "MappedMesh.h"
+#include "Material.h"
+#include "Shape.h"
+#include "SphereSet.h"
+#include "TaskScheduler.h"
+#include "WideBVH.h"
+
+struct PlanePrimitive
+{
+	glm::vec3 m_point;
+	glm::vec3 m_normal;
+	int m_material;
+};
+
+//Edges are stored rather than the other two vertices, Moller-Trumbore only needs these
+struct TrianglePrimitive
+{
+	glm::vec3 m_vertex;
+	glm::vec3 m_edge1;
+	glm::vec3 m_edge2;
+	int m_material;
+};
+
+class FlatScene
+{
+public:
+	//Primitives are referred to by an int, the type in the top bits and the index into that type's array below
+	enum PrimitiveType
+	{
+		primitiveSphere = 0,
+		primitivePlane = 1,
+		primitiveTriangle = 2,
+		primitiveMappedMesh = 3,		//A whole MappedMesh in the BVH, traced through its own BVH
+		primitiveMappedTriangle = 4		//Hit on a MappedMesh triangle, numbered on from the triangles of the meshes before it
+	};
+	static const int typeShift = 28;
+
+	//Variables
+	BVH m_bvh;										//Over spheres and triangles, m_primitives holds tagged references in leaf order,
+													//its nodes are released once collapsed into m_compressedBvh
+	WideBVH m_wideBvh;								//m_bvh collapsed for single rays, packets still trace m_bvh
+	CompressedBVH m_compressedBvh;					//Or collapsed into quantised nodes instead, only one of the two is built
+	bool m_compactBvh;								//m_compressedBvh was built, packets can't be traced
+	SphereSet m_spheres;							//Slot k is BVH slot k, left empty where the slot holds a triangle
+	std::vector<TrianglePrimitive> m_triangles;		//In BVH leaf order
+	std::vector<PlanePrimitive> m_planes;			//Unbounded, tested against every ray
+	std::vector<const MappedMesh *> m_mappedMeshes;	//Owned by the shapes the scene was built from
+	std::vector<int> m_mappedTriangleStart;			//Per mapped mesh, number of the first of its triangles, then the total
+	std::vector<Material> m_materials;
+	bool m_allSpheres;								//No triangles or meshes in the BVH, leaves only need the SIMD sphere test
+	int m_bvhNodes;									//Of m_bvh as built, kept when its nodes are released
+	float m_bvhCost;								//m_bvh's surface area heuristic cost, see BVH::Cost
+
+	//Functions
+	FlatScene();
+	bool Build(const std::vector<std::shared_ptr<Shape>> &_listOfShapes, const std::vector<Material> &_materials, bool _compactBvh, TaskScheduler &_scheduler);	//False with a message printed if a reference can't number every primitive
+	int NumberOfPrimitives() const;
+
+	//Called by Shape::Flatten while building
+	void AddSphere(const glm::vec3 &_centre, float _radius, int _material);
+	void AddPlane(const glm::vec3 &_point, const glm::vec3 &_normal, int _material);
+	void AddTriangle(const glm::vec3 &_v0, const glm::vec3 &_v1, const glm::vec3 &_v2, int _material);
+	void AddMappedMesh(const MappedMesh *_mesh);
+
+	//Closest hit and any hit over the whole scene
+	bool Intersection(HitRecord *_hit, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const;
+	bool Occluded(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT) const;
+
+	//Single primitives, fill in _hit only when nearer than _hit->m_t
+	bool IntersectionPlane(HitRecord *_hit, int _plane, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const;
+	bool IntersectionTriangle(HitRecord *_hit, int _triangle, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const;
+	bool IntersectionMappedMesh(HitRecord *_hit, int _mesh, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const;
+
+	//Shading lookups, the normal is not normalized
+	glm::vec3 Normal(const HitRecord &_hit, const glm::vec3 &_p0) const;
+	const Material &MaterialOf(const HitRecord &_hit) const;
+
+	static int Reference(PrimitiveType _type, int _index)
+	{
+		return ((int)_type << typeShift) | _index;
+	}
+
+	static PrimitiveType Type(int _reference)
+	{
+		return (PrimitiveType)(_reference >> typeShift);
+	}
+
+	static int Index(int _reference)
+	{
+		return _reference & ((1 << typeShift) - 1);
+	}
+
+private:
+	//Variables
+	//Gathered from the shapes before the BVH decides their order
+	std::vector<glm::vec4> m_unsortedSpheres;		//Centre and radius
+	std::vector<int> m_unsortedSphereMaterials;
+	std::vector<TrianglePrimitive> m_unsortedTriangles;
+
+	//Functions
+	int MappedMeshOf(int _triangle) const;	//Mapped mesh a primitiveMappedTriangle index falls in
+
+	//Non-copyable, like the SphereSet it owns
+	FlatScene(const FlatScene &);
+	FlatScene &operator=(const FlatScene &);
+};
+
+#endif // _FLATSCENE_H_
\ No newline at end of file
@@ -0,0 +1,80 @@
+/// @file Framebuffer.cpp
+/// @brief Contiguous image storage, replaces the array of separately allocated columns
+
+#include <cstring>
+
+#include "AlignedMemory.h"
+#include "Framebuffer.h"
+
+Framebuffer::Framebuffer()
+{
+	m_pixels = nullptr;
+	m_width = 0;
+	m_height = 0;
+}
+
+Framebuffer::Framebuffer(int _width, int _height)
+{
+	m_pixels = nullptr;
+	m_width = 0;
+	m_height = 0;
+	Resize(_width, _height);
+}
+
+Framebuffer::~Framebuffer()
+{
+	AlignedFree(m_pixels);
+}
+
+void Framebuffer::Resize(int _width, int _height)
+{
+	//Repeated renders at the same size keep their allocation
+	if (m_pixels != nullptr && _width == m_width && _height == m_height)
+	{
+		return;
+	}
+	AlignedFree(m_pixels);
+
+	//Single allocation for the whole image, starting on a cache line
+	m_width = _width;
+	m_height = _height;
+	m_pixels = (glm::vec3 *)AlignedAllocate((size_t)_width * _height * sizeof(glm::vec3));
+	Clear(glm::vec3(0, 0, 0));
+}
+
+void Framebuffer::Clear(glm::vec3 _colour)
+{
+	size_t numberOfPixels = (size_t)m_width * m_height;
+	for (size_t k = 0; k < numberOfPixels; ++k)
+	{
+		m_pixels[k] = _colour;
+	}
+}
+
+void Framebuffer::CopyFrom(const Framebuffer &_other)
+{
+	Resize(_other.m_width, _other.m_height);
+	std::memcpy(m_pixels, _other.m_pixels, (size_t)m_width * m_height * sizeof(glm::vec3));
+}
+
+int Framebuffer::Width() const
+{
+	return m_width;
+}
+
+int Framebuffer::Height() const
+{
+	return m_height;
+}
+
+FramebufferTile Framebuffer::Tile(int _startX, int _startY, int _width, int _height)
+{
+	FramebufferTile tile;
+	tile.m_pixels = &Pixel(_startX, _startY);
+	tile.m_stride = m_width;
+	tile.m_startX = _startX;
+	tile.m_startY = _startY;
+	tile.m_width = _width;
+	tile.m_height = _height;
+	return tile;
+}
\ No newline at end of file
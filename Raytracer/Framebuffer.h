@@ -0,0 +1,65 @@
+/// \file Framebuffer.h
+/// \brief image the renderer writes into, one aligned row-major allocation sized at runtime
+/// \author Josh Bailey
+
+#ifndef _FRAMEBUFFER_H_
+#define _FRAMEBUFFER_H_
+
+//File includes
+#include <glm.hpp>
+
+//Rectangle of a framebuffer owned by one worker, pixels are addressed with image coordinates
+class FramebufferTile
+{
+public:
+	//Variables
+	glm::vec3 *m_pixels;	//Pixel (m_startX, m_startY)
+	int m_stride;			//Pixels from one row to the next
+	int m_startX;
+	int m_startY;
+	int m_width;
+	int m_height;
+
+	//Functions
+	glm::vec3 &Pixel(int _x, int _y)
+	{
+		return m_pixels[(_y - m_startY) * m_stride + (_x - m_startX)];
+	}
+};
+
+class Framebuffer
+{
+public:
+	//Functions
+	Framebuffer();
+	Framebuffer(int _width, int _height);
+	~Framebuffer();
+	void Resize(int _width, int _height);
+	void Clear(glm::vec3 _colour);
+	void CopyFrom(const Framebuffer &_other);	//Resizes to match, for snapshots taken while rendering carries on
+	int Width() const;
+	int Height() const;
+	FramebufferTile Tile(int _startX, int _startY, int _width, int _height);
+
+	//Row-major, so walking x in the inner loop is sequential in memory
+	glm::vec3 &Pixel(int _x, int _y)
+	{
+		return m_pixels[(size_t)_y * m_width + _x];
+	}
+	const glm::vec3 &Pixel(int _x, int _y) const
+	{
+		return m_pixels[(size_t)_y * m_width + _x];
+	}
+
+private:
+	//Variables
+	glm::vec3 *m_pixels;
+	int m_width;
+	int m_height;
+
+	//Non-copyable, owns its pixels
+	Framebuffer(const Framebuffer &);
+	Framebuffer &operator=(const Framebuffer &);
+};
+
+#endif // _FRAMEBUFFER_H_
\ No newline at end of file
@@ -0,0 +1,132 @@
+/// @file GeometryFile.cpp
+/// @brief Reorders the triangles into BVH leaf order so the mapped file needs no primitive index list
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+#include "AlignedMemory.h"
+#include "BVH.h"
+#include "FileUtilities.h"
+#include "GeometryFile.h"
+#include "Mesh.h"
+
+//Sections are used in place straight from the file, so their layout is part of the format
+static_assert(sizeof(glm::vec3) == 12 && std::is_trivially_copyable<glm::vec3>::value, "vertices must be three packed floats");
+static_assert(sizeof(BVHNode) == 32 && std::is_trivially_copyable<BVHNode>::value, "BVHNode must be 32 bytes of plain data");
+static_assert(sizeof(GeometryHeader) == 24 && sizeof(GeometrySection) == 24, "geometry file headers must be packed");
+
+static const int geometryNumberOfSections = 3;
+
+static unsigned long long AlignToCacheLine(unsigned long long _offset)
+{
+	return (_offset + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+}
+
+//Zeros up to the next section, so padding is the same in every file
+static void PadTo(std::ofstream &_ofs, unsigned long long _offset)
+{
+	static const char zeros[cacheLineSize] = {};
+	unsigned long long position = (unsigned long long)_ofs.tellp();
+	_ofs.write(zeros, (std::streamsize)(_offset - position));
+}
+
+bool WriteGeometryFile(const std::string &_path, const std::vector<glm::vec3> &_vertices, const std::vector<unsigned int> &_indices)
+{
+	int numberOfTriangles = (int)(_indices.size() / 3);
+	std::vector<AABB> bounds(numberOfTriangles);
+	for (int k = 0; k < numberOfTriangles; ++k)
+	{
+		bounds[k].Grow(_vertices[_indices[3 * k]]);
+		bounds[k].Grow(_vertices[_indices[3 * k + 1]]);
+		bounds[k].Grow(_vertices[_indices[3 * k + 2]]);
+	}
+	BVH bvh;
+	bvh.Build(bounds);
+
+	//Triangle k of the file is the BVH's primitive k, leaves already index triangles directly
+	std::vector<unsigned int> indices(_indices.size());
+	for (int k = 0; k < numberOfTriangles; ++k)
+	{
+		std::memcpy(&indices[3 * k], &_indices[3 * bvh.m_primitives[k]], 3 * sizeof(unsigned int));
+	}
+
+	GeometrySection sections[geometryNumberOfSections];
+	sections[0].m_type = geometryVertices;
+	sections[0].m_elementSize = sizeof(glm::vec3);
+	sections[0].m_count = _vertices.size();
+	sections[1].m_type = geometryIndices;
+	sections[1].m_elementSize = sizeof(unsigned int);
+	sections[1].m_count = indices.size();
+	sections[2].m_type = geometryNodes;
+	sections[2].m_elementSize = sizeof(BVHNode);
+	sections[2].m_count = bvh.m_nodes.size();
+	const void *data[geometryNumberOfSections] = { _vertices.data(), indices.data(), bvh.m_nodes.data() };
+
+	unsigned long long offset = sizeof(GeometryHeader) + sizeof(sections);
+	for (GeometrySection &section : sections)
+	{
+		section.m_offset = AlignToCacheLine(offset);
+		offset = section.m_offset + section.m_elementSize * section.m_count;
+	}
+
+	GeometryHeader header;
+	std::memcpy(header.m_magic, geometryFileMagic, sizeof(header.m_magic));
+	header.m_version = geometryFileVersion;
+	header.m_byteOrder = geometryFileByteOrder;
+	header.m_numberOfSections = geometryNumberOfSections;
+	header.m_reserved = 0;
+
+	//Renamed into place, a process mapping the old file keeps its pages
+	std::string partial = _path + ".part";
+	std::ofstream ofs(partial.c_str(), std::ios::out | std::ios::binary);
+	if (!ofs)
+	{
+		std::cout << "Could not write " << _path << std::endl;
+		return false;
+	}
+	ofs.write((const char *)&header, sizeof(header));
+	ofs.write((const char *)sections, sizeof(sections));
+	for (int s = 0; s < geometryNumberOfSections; ++s)
+	{
+		PadTo(ofs, sections[s].m_offset);
+		ofs.write((const char *)data[s], (std::streamsize)(sections[s].m_elementSize * sections[s].m_count));
+	}
+	ofs.close();
+	if (ofs.fail() || !ReplaceFile(partial, _path))
+	{
+		std::cout << "Could not write " << _path << std::endl;
+		return false;
+	}
+
+	std::cout << "Wrote " << _path << ": " << _vertices.size() << " vertices, " << numberOfTriangles << " triangles, " << bvh.m_nodes.size() << " BVH nodes" << std::endl;
+	return true;
+}
+
+bool WriteSceneGeometry(const std::string &_path, const SceneDescription &_scene)
+{
+	std::vector<glm::vec3> vertices;
+	std::vector<unsigned int> indices;
+	for (const std::shared_ptr<Shape> &shape : _scene.m_listOfShapes)
+	{
+		const Mesh *mesh = dynamic_cast<const Mesh *>(shape.get());
+		if (mesh == nullptr)
+		{
+			continue;
+		}
+		unsigned int first = (unsigned int)vertices.size();
+		vertices.insert(vertices.end(), mesh->m_vertices.begin(), mesh->m_vertices.end());
+		for (unsigned int index : mesh->m_indices)
+		{
+			indices.push_back(first + index);
+		}
+	}
+
+	if (indices.empty())
+	{
+		std::cout << "The scene has no triangle meshes to write to " << _path << std::endl;
+		return false;
+	}
+	return WriteGeometryFile(_path, vertices, indices);
+}
\ No newline at end of file
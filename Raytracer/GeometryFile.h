@@ -0,0 +1,51 @@
+/// \file GeometryFile.h
+/// \brief binary triangle mesh container laid out to be memory mapped and traced in place, see MappedMesh
+/// \author Josh Bailey
+
+#ifndef _GEOMETRYFILE_H_
+#define _GEOMETRYFILE_H_
+
+//File includes
+#include <string>
+#include <vector>
+#include <glm.hpp>
+
+#include "Scenes.h"
+
+//A header, a table of sections, then each section starting on a cache line. Readers skip section types they don't
+//know and refuse a file whose version, byte order or element sizes differ from their own
+static const char geometryFileMagic[8] = { 'R', 'T', 'G', 'E', 'O', 'M', '\0', '\0' };
+static const unsigned int geometryFileVersion = 1;
+static const unsigned int geometryFileByteOrder = 0x01020304;	//Reads back differently on a machine of the other endianness
+
+enum GeometrySectionType
+{
+	geometryVertices = 1,	//glm::vec3 per vertex
+	geometryIndices = 2,	//Three unsigned ints per triangle, triangles in BVH leaf order
+	geometryNodes = 3		//BVHNode, a leaf's m_leftOrFirst is its first triangle, no primitive index list is needed
+};
+
+struct GeometryHeader
+{
+	char m_magic[8];
+	unsigned int m_version;
+	unsigned int m_byteOrder;
+	unsigned int m_numberOfSections;
+	unsigned int m_reserved;
+};
+
+struct GeometrySection
+{
+	unsigned int m_type;
+	unsigned int m_elementSize;		//sizeof one element, so a reader built with different padding refuses it
+	unsigned long long m_offset;	//From the start of the file, a multiple of cacheLineSize
+	unsigned long long m_count;
+};
+
+//Builds a BVH over the triangles and writes them in its leaf order, false with a message printed if it can't be written
+bool WriteGeometryFile(const std::string &_path, const std::vector<glm::vec3> &_vertices, const std::vector<unsigned int> &_indices);
+
+//Every Mesh in the scene merged into one container, the material comes from whatever scene maps it
+bool WriteSceneGeometry(const std::string &_path, const SceneDescription &_scene);
+
+#endif // _GEOMETRYFILE_H_
\ No newline at end of file
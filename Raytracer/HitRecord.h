@@ -0,0 +1,34 @@
+/// \file HitRecord.h
+/// \brief compact result of the intersection phase, everything shading needs to find the surface again
+/// \author Josh Bailey
+
+#ifndef _HITRECORD_H_
+#define _HITRECORD_H_
+
+//File includes
+#include <cmath>
+#include <glm.hpp>
+
+//16 bytes, shading reads the position, normal and material back from these
+struct HitRecord
+{
+	//Variables
+	float m_t;			//Distance along the ray, only hits nearer than this are recorded
+	int m_primitive;	//Tagged FlatScene primitive, -1 until something is hit
+	glm::vec2 m_uv;		//Barycentric weights of a triangle's second and third vertex, (0, 0) for other shapes
+
+	//Functions
+	HitRecord()
+	{
+		m_t = INFINITY;
+		m_primitive = -1;
+		m_uv = glm::vec2(0, 0);
+	}
+
+	bool Hit() const
+	{
+		return m_primitive != -1;
+	}
+};
+
+#endif // _HITRECORD_H_
\ No newline at end of file
@@ -0,0 +1,105 @@
+/// @file Integrator.cpp
+/// @brief What the integrators share, and picking one from the settings
+
+#include <cmath>
+
+#include "Integrator.h"
+#include "PathIntegrator.h"
+#include "WhittedIntegrator.h"
+
+Integrator::Integrator(const FlatScene &_scene, const SceneDescription &_description, const RenderSettings &_settings) :
+	m_scene(_scene), m_description(_description), m_settings(_settings)
+{
+}
+
+Integrator::~Integrator()
+{
+}
+
+QueuedRay Integrator::CameraRay(glm::vec3 _originOfRay, glm::vec3 _directionOfRay, int _pixel, int _sample, int _colour) const
+{
+	QueuedRay ray;
+	ray.m_origin = _originOfRay;
+	ray.m_direction = _directionOfRay;
+	ray.m_pixel = _colour;
+	ray.m_random = Random(_pixel, _sample);
+	return ray;
+}
+
+PCG32 Integrator::Random(int _pixel, int _sample) const
+{
+	//Streams past the last pixel's are left to the sample jitter
+	return PCG32((uint64_t)_sample, (uint64_t)m_settings.m_imageWidth * m_settings.m_imageHeight + _pixel);
+}
+
+bool Integrator::Survives(glm::vec3 *_weight, PCG32 &_random) const
+{
+	//Weak rays carry on at random, weighted up by the odds they survived against, so the mean is unchanged
+	float strength = glm::max(_weight->x, glm::max(_weight->y, _weight->z));
+	if (strength <= 0.0f)
+	{
+		return false;
+	}
+	if (strength < m_settings.m_rouletteThreshold)
+	{
+		float survival = strength / m_settings.m_rouletteThreshold;
+		if (_random.NextFloat() >= survival)
+		{
+			return false;
+		}
+		*_weight /= survival;
+	}
+	return true;
+}
+
+SurfaceSplit Integrator::Split(const Material &_material, glm::vec3 _directionOfRay, glm::vec3 _normal)
+{
+	SurfaceSplit split;
+
+	//Normals face out, a ray leaving the inside of a transparent shape sees it flipped and the indices swapped
+	split.m_normal = _normal;
+	split.m_cosine = -glm::dot(_directionOfRay, _normal);
+	bool leaving = split.m_cosine < 0.0f;
+	if (leaving)
+	{
+		split.m_normal = -_normal;
+		split.m_cosine = -split.m_cosine;
+	}
+	bool transparent = _material.m_transparency > 0.0f;
+	float eta = leaving ? _material.m_refractiveIndex : 1.0f / _material.m_refractiveIndex;	//Index of the side the ray comes from over the side it enters
+	float sinSquaredTransmitted = eta * eta * (1.0f - split.m_cosine * split.m_cosine);
+	bool totalInternalReflection = transparent && sinSquaredTransmitted > 1.0f;
+
+	//Glass reflects as its index says, opaque surfaces as their reflectivity says, going from the denser side the
+	//transmitted angle is the one that reaches grazing first
+	split.m_fresnel = 1.0f;
+	if (!totalInternalReflection)
+	{
+		float reflectance = _material.m_reflectivity;
+		if (transparent)
+		{
+			float ratio = (_material.m_refractiveIndex - 1.0f) / (_material.m_refractiveIndex + 1.0f);
+			reflectance = ratio * ratio;
+		}
+		float cosineFresnel = transparent && eta > 1.0f ? std::sqrt(1.0f - sinSquaredTransmitted) : split.m_cosine;
+		split.m_fresnel = reflectance + (1.0f - reflectance) * std::pow(1.0f - cosineFresnel, 5.0f);
+	}
+
+	split.m_reflected = glm::normalize(_directionOfRay + 2.0f * split.m_cosine * split.m_normal);
+	split.m_refracts = transparent && !totalInternalReflection;
+	split.m_refracted = glm::vec3(0, 0, 0);
+	if (split.m_refracts)
+	{
+		split.m_refracted = glm::normalize(eta * _directionOfRay + (eta * split.m_cosine - std::sqrt(1.0f - sinSquaredTransmitted)) * split.m_normal);
+	}
+	return split;
+}
+
+std::unique_ptr<Integrator> CreateIntegrator(const FlatScene &_scene, const SceneDescription &_description, const RenderSettings &_settings)
+{
+	if (_settings.m_integrator == integratorPath)
+	{
+		return std::unique_ptr<Integrator>(new PathIntegrator(_scene, _description, _settings));
+	}
+	return std::unique_ptr<Integrator>(new WhittedIntegrator(_scene, _description, _settings));
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+/// \file Integrator.h
+/// \brief base class for the ways a camera ray is turned into a colour, so one render driver can preview or finish a scene
+/// \author Josh Bailey
+
+#ifndef _INTEGRATOR_H_
+#define _INTEGRATOR_H_
+
+//File includes
+#include <memory>
+#include <glm.hpp>
+
+#include "FlatScene.h"
+#include "HitRecord.h"
+#include "Material.h"
+#include "Random.h"
+#include "RayQueue.h"
+#include "RenderSettings.h"
+#include "Scenes.h"
+
+//What a mirror or glass surface does to a ray arriving at it
+struct SurfaceSplit
+{
+	glm::vec3 m_normal;			//Facing the side the ray came from
+	float m_cosine;				//Between the ray, reversed, and m_normal
+	float m_fresnel;			//Share of the light reflected, 1 under total internal reflection
+	bool m_refracts;			//Some light passes through, along m_refracted
+	glm::vec3 m_reflected;
+	glm::vec3 m_refracted;
+};
+
+class Integrator
+{
+public:
+	//Functions
+	Integrator(const FlatScene &_scene, const SceneDescription &_description, const RenderSettings &_settings);
+	virtual ~Integrator();
+	//Colour a camera ray brings back, given its closest hit (the renderer intersects camera rays itself so packets can
+	//be used), rays traced beyond it are added to _rays
+	virtual glm::vec3 Radiance(const HitRecord &_hit, glm::vec3 _originOfRay, glm::vec3 _directionOfRay, int _pixel, int _sample, long long *_rays) = 0;
+	//Shade stage of a Wavefront: adds what the ray found to _colours, queues the shadow rays whose contribution waits on
+	//the connect stage and the bounces for the next extend
+	virtual void Shade(const QueuedRay &_ray, const HitRecord &_hit, RayQueue &_bounces, ShadowQueue &_shadowRays, glm::vec3 *_colours) = 0;
+	QueuedRay CameraRay(glm::vec3 _originOfRay, glm::vec3 _directionOfRay, int _pixel, int _sample, int _colour) const;	//As the generate stage queues it, _colour indexes the wavefront's colours
+
+protected:
+	//Variables
+	const FlatScene &m_scene;
+	const SceneDescription &m_description;	//Lights and camera
+	const RenderSettings &m_settings;
+
+	//Functions
+	PCG32 Random(int _pixel, int _sample) const;	//A stream for the integrator's own choices, apart from the sample jitter's
+	bool Survives(glm::vec3 *_weight, PCG32 &_random) const;	//Russian roulette, false ends the ray, else _weight is raised by the odds it survived
+	static SurfaceSplit Split(const Material &_material, glm::vec3 _directionOfRay, glm::vec3 _normal);	//Schlick's approximation of Fresnel
+};
+
+//The integrator m_settings.m_integrator names, for a renderer whose scene and settings outlive it
+std::unique_ptr<Integrator> CreateIntegrator(const FlatScene &_scene, const SceneDescription &_description, const RenderSettings &_settings);
+
+#endif // _INTEGRATOR_H_
\ No newline at end of file
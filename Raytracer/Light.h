@@ -0,0 +1,31 @@
+/// \file Light.h
+/// \brief point light, the scene can have any number of them
+/// \author Josh Bailey
+
+#ifndef _LIGHT_H_
+#define _LIGHT_H_
+
+//File includes
+#include <glm.hpp>
+
+struct Light
+{
+	//Variables
+	glm::vec3 m_position;
+	glm::vec3 m_intensity;	//Brightness of the light in each channel
+
+	//Functions
+	Light()
+	{
+		m_position = glm::vec3(0, 0, 0);
+		m_intensity = glm::vec3(1, 1, 1);
+	}
+
+	Light(glm::vec3 _position, glm::vec3 _intensity)
+	{
+		m_position = _position;
+		m_intensity = _intensity;
+	}
+};
+
+#endif // _LIGHT_H_
\ No newline at end of file
@@ -0,0 +1,82 @@
+/// \file LineReader.h
+/// \brief reads a text file in large blocks and hands each line over in place, for loaders of big files
+/// \author Josh Bailey
+
+#ifndef _LINEREADER_H_
+#define _LINEREADER_H_
+
+//File includes
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static const size_t lineReaderBlockSize = 1 << 20;	//Bytes read from disk at a time
+
+//_parseLine(char *line, unsigned int lineNumber) gets every line, null terminated without its newline, and returns
+//false to stop, nothing is allocated per line. False if the file can't be opened or a line stopped it
+template <typename ParseLine>
+bool ReadLines(const std::string &_path, ParseLine _parseLine)
+{
+	FILE *file = std::fopen(_path.c_str(), "rb");
+	if (file == nullptr)
+	{
+		std::cout << "Could not open " << _path << std::endl;
+		return false;
+	}
+
+	//Block of the file plus whatever partial line was left over from the last block
+	std::vector<char> buffer(lineReaderBlockSize + 1);
+	size_t carried = 0;
+	unsigned int lineNumber = 0;
+	bool valid = true;
+
+	while (valid)
+	{
+		//A single line longer than the buffer, make room for it
+		if (carried == buffer.size() - 1)
+		{
+			buffer.resize(buffer.size() * 2);
+		}
+
+		size_t bytesRead = std::fread(buffer.data() + carried, 1, buffer.size() - 1 - carried, file);
+		size_t filled = carried + bytesRead;
+		bool endOfFile = bytesRead == 0;
+		if (endOfFile)
+		{
+			if (filled == 0)
+			{
+				break;
+			}
+			//Last line without a newline
+			buffer[filled++] = '\n';
+		}
+
+		//Terminate each complete line in place and parse it
+		char *lineStart = buffer.data();
+		char *blockEnd = buffer.data() + filled;
+		char *newline = nullptr;
+		while (valid && (newline = (char *)std::memchr(lineStart, '\n', blockEnd - lineStart)) != nullptr)
+		{
+			*newline = '\0';
+			++lineNumber;
+			valid = _parseLine(lineStart, lineNumber);
+			lineStart = newline + 1;
+		}
+
+		if (endOfFile)
+		{
+			break;
+		}
+
+		//Move the unfinished line to the front for the next block
+		carried = blockEnd - lineStart;
+		std::memmove(buffer.data(), lineStart, carried);
+	}
+
+	std::fclose(file);
+	return valid;
+}
+
+#endif // _LINEREADER_H_
\ No newline at end of file
@@ -0,0 +1,123 @@
+/// @file MappedFile.cpp
+/// @brief MapViewOfFile on Windows, mmap elsewhere, both mapping the file read-only and shared
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile()
+{
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping = nullptr;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string &_path)
+{
+	Close();
+	HANDLE file = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+
+	//The mapping keeps the file open, its own handle isn't needed any more
+	CloseHandle(file);
+	if (mapping == nullptr)
+	{
+		return false;
+	}
+
+	m_data = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_data == nullptr)
+	{
+		CloseHandle(mapping);
+		return false;
+	}
+	m_size = (size_t)size.QuadPart;
+	m_mapping = mapping;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+		CloseHandle((HANDLE)m_mapping);
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping = nullptr;
+}
+#else
+bool MappedFile::Open(const std::string &_path)
+{
+	Close();
+	int file = open(_path.c_str(), O_RDONLY);
+	if (file == -1)
+	{
+		return false;
+	}
+
+	struct stat status;
+	void *data = MAP_FAILED;
+	if (fstat(file, &status) == 0 && status.st_size > 0)
+	{
+		data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+	}
+
+	//The mapping keeps the file open, its descriptor isn't needed any more
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	m_data = (const unsigned char *)data;
+	m_size = (size_t)status.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+	{
+		munmap((void *)m_data, m_size);
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping = nullptr;
+}
+#endif
+
+const unsigned char *MappedFile::Data() const
+{
+	return m_data;
+}
+
+size_t MappedFile::Size() const
+{
+	return m_size;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+/// \file MappedFile.h
+/// \brief read-only memory mapping of a whole file, pages are shared with every other process mapping it
+/// \author Josh Bailey
+
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+
+//File includes
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+public:
+	//Functions
+	MappedFile();
+	~MappedFile();
+	bool Open(const std::string &_path);	//False if the file can't be opened or is empty
+	void Close();
+	const unsigned char *Data() const;		//Page aligned, nullptr when closed
+	size_t Size() const;
+
+private:
+	//Variables
+	const unsigned char *m_data;
+	size_t m_size;
+	void *m_mapping;	//Handle of the file mapping object on Windows, unused elsewhere
+
+	//Non-copyable, owns its mapping
+	MappedFile(const MappedFile &);
+	MappedFile &operator=(const MappedFile &);
+};
+
+#endif // _MAPPEDFILE_H_
\ No newline at end of file
@@ -0,0 +1,232 @@
+/// @file MappedMesh.cpp
+/// @brief Checks the geometry file's layout once on load, then traces its triangles in place with Moller-Trumbore
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "AlignedMemory.h"
+#include "FlatScene.h"
+#include "GeometryFile.h"
+#include "MappedMesh.h"
+
+MappedMesh::MappedMesh(int _material)
+{
+	m_position = glm::vec3(0, 0, 0);
+	m_material = _material;
+	m_vertices = nullptr;
+	m_indices = nullptr;
+	m_nodes = nullptr;
+	m_numberOfTriangles = 0;
+	m_numberOfNodes = 0;
+}
+
+bool MappedMesh::Open(const std::string &_path)
+{
+	if (!m_file.Open(_path))
+	{
+		std::cout << "Could not open " << _path << std::endl;
+		return false;
+	}
+
+	const unsigned char *data = m_file.Data();
+	size_t size = m_file.Size();
+	GeometryHeader header;
+	if (size < sizeof(header))
+	{
+		std::cout << _path << " is not a geometry file" << std::endl;
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.m_magic, geometryFileMagic, sizeof(header.m_magic)) != 0)
+	{
+		std::cout << _path << " is not a geometry file" << std::endl;
+		return false;
+	}
+	if (header.m_version != geometryFileVersion || header.m_byteOrder != geometryFileByteOrder ||
+		header.m_numberOfSections > (size - sizeof(header)) / sizeof(GeometrySection))
+	{
+		std::cout << _path << " was written by another version or on another kind of machine" << std::endl;
+		return false;
+	}
+
+	//Sections are found by type, any this version doesn't know are skipped
+	unsigned long long vertices = 0;
+	unsigned long long indices = 0;
+	unsigned long long nodes = 0;
+	for (unsigned int s = 0; s < header.m_numberOfSections; ++s)
+	{
+		GeometrySection section;
+		std::memcpy(&section, data + sizeof(header) + s * sizeof(section), sizeof(section));
+		const void *start = data + section.m_offset;
+		bool inFile = section.m_offset % cacheLineSize == 0 && section.m_offset <= size && section.m_elementSize > 0 &&
+			section.m_count <= (size - section.m_offset) / section.m_elementSize;
+		bool valid = inFile;
+		if (section.m_type == geometryVertices)
+		{
+			valid = inFile && section.m_elementSize == sizeof(glm::vec3);
+			m_vertices = (const glm::vec3 *)start;
+			vertices = section.m_count;
+		}
+		else if (section.m_type == geometryIndices)
+		{
+			valid = inFile && section.m_elementSize == sizeof(unsigned int) && section.m_count % 3 == 0;
+			m_indices = (const unsigned int *)start;
+			indices = section.m_count;
+		}
+		else if (section.m_type == geometryNodes)
+		{
+			valid = inFile && section.m_elementSize == sizeof(BVHNode);
+			m_nodes = (const BVHNode *)start;
+			nodes = section.m_count;
+		}
+		if (!valid)
+		{
+			std::cout << _path << " has a damaged or incompatible section table" << std::endl;
+			return false;
+		}
+	}
+	if (m_vertices == nullptr || m_indices == nullptr || m_nodes == nullptr || indices / 3 >= (1ULL << FlatScene::typeShift) || nodes > 0x7fffffff)
+	{
+		std::cout << _path << " is missing the vertices, triangles or BVH" << std::endl;
+		return false;
+	}
+	m_numberOfTriangles = (int)(indices / 3);
+	m_numberOfNodes = (int)nodes;
+
+	//The nodes are few next to the triangles, check them so a damaged file can't send traversal outside the mapping
+	//or deeper than its stack, the vertex indices are trusted rather than touching every page of a large file.
+	//Children come after their parents, so a node's depth is final before it is checked, the deepest of its parents
+	//when a damaged file gives it more than one
+	std::vector<unsigned char> depth(m_numberOfNodes, 0);
+	for (int k = 0; k < m_numberOfNodes; ++k)
+	{
+		const BVHNode &node = m_nodes[k];
+		bool valid = node.m_count > 0 ? node.m_leftOrFirst >= 0 && node.m_leftOrFirst <= m_numberOfTriangles - node.m_count :
+			node.m_count == 0 && node.m_leftOrFirst > k && node.m_leftOrFirst < m_numberOfNodes - 1 && depth[k] < bvhMaxDepth;
+		if (!valid)
+		{
+			std::cout << _path << " has a damaged BVH" << std::endl;
+			return false;
+		}
+		if (node.m_count == 0)
+		{
+			depth[node.m_leftOrFirst] = (unsigned char)std::max<int>(depth[node.m_leftOrFirst], depth[k] + 1);
+			depth[node.m_leftOrFirst + 1] = (unsigned char)std::max<int>(depth[node.m_leftOrFirst + 1], depth[k] + 1);
+		}
+	}
+	if (vertices == 0 && m_numberOfTriangles > 0)
+	{
+		std::cout << _path << " has triangles but no vertices" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int MappedMesh::NumberOfTriangles() const
+{
+	return m_numberOfTriangles;
+}
+
+bool MappedMesh::IntersectionTriangle(float *_t, glm::vec2 *_uv, int _triangle, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const
+{
+	//Same method as FlatScene::IntersectionTriangle, working the edges out here
+	const glm::vec3 &v0 = m_vertices[m_indices[3 * _triangle]];
+	const glm::vec3 &v1 = m_vertices[m_indices[3 * _triangle + 1]];
+	const glm::vec3 &v2 = m_vertices[m_indices[3 * _triangle + 2]];
+
+	glm::vec3 edge1 = v1 - v0;
+	glm::vec3 edge2 = v2 - v0;
+	glm::vec3 p = glm::cross(_directionOfRay, edge2);
+	float determinant = glm::dot(edge1, p);
+	if (determinant == 0.0f)
+	{
+		return false;
+	}
+	float inverseDeterminant = 1.0f / determinant;
+
+	glm::vec3 toOrigin = _originOfRay - v0;
+	float u = glm::dot(toOrigin, p) * inverseDeterminant;
+	if (u < 0.0f || u > 1.0f)
+	{
+		return false;
+	}
+
+	glm::vec3 q = glm::cross(toOrigin, edge1);
+	float v = glm::dot(_directionOfRay, q) * inverseDeterminant;
+	if (v < 0.0f || u + v > 1.0f)
+	{
+		return false;
+	}
+
+	float t = glm::dot(edge2, q) * inverseDeterminant;
+	*_t = t;
+	*_uv = glm::vec2(u, v);
+	return t >= 0.0f;
+}
+
+bool MappedMesh::ClosestHit(float *_minT, int *_triangle, glm::vec2 *_uv, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const
+{
+	//Leaves index the triangles directly, the file stores them in leaf order
+	return BVH::Intersection(m_nodes, m_numberOfNodes, _minT, _triangle, _originOfRay, _directionOfRay, [&](int first, int count, float *leafMinT, int *leafHitTriangle)
+	{
+		bool hitLeaf = false;
+		for (int k = first; k < first + count; ++k)
+		{
+			float t = 0.0f;
+			glm::vec2 uv;
+			if (IntersectionTriangle(&t, &uv, k, _originOfRay, _directionOfRay) && t < *leafMinT)
+			{
+				*leafMinT = t;
+				*leafHitTriangle = k;
+				*_uv = uv;
+				hitLeaf = true;
+			}
+		}
+		return hitLeaf;
+	});
+}
+
+bool MappedMesh::AnyHit(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT) const
+{
+	return BVH::Occluded(m_nodes, m_numberOfNodes, _originOfRay, _directionOfRay, _maxT, [&](int first, int count)
+	{
+		for (int k = first; k < first + count; ++k)
+		{
+			float t = 0.0f;
+			glm::vec2 uv;
+			if (IntersectionTriangle(&t, &uv, k, _originOfRay, _directionOfRay) && t < _maxT)
+			{
+				return true;
+			}
+		}
+		return false;
+	});
+}
+
+glm::vec3 MappedMesh::FaceNormal(int _triangle) const
+{
+	//Counter-clockwise winding faces outwards
+	const glm::vec3 &v0 = m_vertices[m_indices[3 * _triangle]];
+	const glm::vec3 &v1 = m_vertices[m_indices[3 * _triangle + 1]];
+	const glm::vec3 &v2 = m_vertices[m_indices[3 * _triangle + 2]];
+	return glm::cross(v1 - v0, v2 - v0);
+}
+
+AABB MappedMesh::Bounds() const
+{
+	if (m_numberOfNodes == 0)
+	{
+		return AABB();
+	}
+	return m_nodes[0].m_bounds;
+}
+
+void MappedMesh::Flatten(FlatScene *_scene)
+{
+	if (m_numberOfTriangles > 0)
+	{
+		_scene->AddMappedMesh(this);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+/// \file MappedMesh.h
+/// \brief triangle mesh traced straight out of a memory mapped geometry file, nothing is parsed or copied on load
+/// \author Josh Bailey
+
+#ifndef _MAPPEDMESH_H_
+#define _MAPPEDMESH_H_
+
+//File includes
+#include <string>
+#include <glm.hpp>
+
+#include "BVH.h"
+#include "MappedFile.h"
+#include "Shape.h"
+
+class MappedMesh : public Shape	//Inheritance from Shape
+{
+public:
+	//Functions
+	MappedMesh(int _material);
+	bool Open(const std::string &_path);	//False with a message printed if it isn't a geometry file this build can use
+	int NumberOfTriangles() const;
+	AABB Bounds() const;
+
+	//Closest triangle nearer than _minT through the file's own BVH, lowering _minT to it
+	bool ClosestHit(float *_minT, int *_triangle, glm::vec2 *_uv, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const;
+	bool AnyHit(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT) const;
+	glm::vec3 FaceNormal(int _triangle) const;
+	void Flatten(FlatScene *_scene);	//Added whole, the scene's BVH leads to the file's BVH rather than to each triangle
+
+private:
+	//Variables
+	MappedFile m_file;
+	const glm::vec3 *m_vertices;		//Sections of m_file, used where they are
+	const unsigned int *m_indices;
+	const BVHNode *m_nodes;
+	int m_numberOfTriangles;
+	int m_numberOfNodes;
+
+	//Functions
+	bool IntersectionTriangle(float *_t, glm::vec2 *_uv, int _triangle, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay) const;
+};
+
+#endif // _MAPPEDMESH_H_
\ No newline at end of file
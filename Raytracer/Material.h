@@ -0,0 +1,58 @@
+/// \file Material.h
+/// \brief phong surface properties plus mirror and glass, shapes refer to one by index so shading looks it up once per hit
+/// \author Josh Bailey
+
+#ifndef _MATERIAL_H_
+#define _MATERIAL_H_
+
+//File includes
+#include <glm.hpp>
+
+struct Material
+{
+	//Variables
+	glm::vec3 m_diffuse;
+	glm::vec3 m_specular;
+	int m_shine;			//Specular exponent, 0 gives a constant specular term
+	float m_reflectivity;	//Mirror reflectance facing the viewer, tinted by m_specular and raised at grazing angles
+	float m_transparency;	//Share of the light not reflected that passes through rather than being shaded
+	float m_refractiveIndex;	//Of the inside, for transparent materials, reflectance then follows from Fresnel
+
+	//Functions
+	Material()
+	{
+		m_diffuse = glm::vec3(0, 0, 0);
+		m_specular = glm::vec3(0, 0, 0);
+		m_shine = 0;
+		m_reflectivity = 0.0f;
+		m_transparency = 0.0f;
+		m_refractiveIndex = 1.0f;
+	}
+
+	Material(glm::vec3 _diffuse, glm::vec3 _specular, int _shine)
+	{
+		m_diffuse = _diffuse;
+		m_specular = _specular;
+		m_shine = _shine;
+		m_reflectivity = 0.0f;
+		m_transparency = 0.0f;
+		m_refractiveIndex = 1.0f;
+	}
+
+	Material(glm::vec3 _diffuse, glm::vec3 _specular, int _shine, float _reflectivity, float _transparency, float _refractiveIndex)
+	{
+		m_diffuse = _diffuse;
+		m_specular = _specular;
+		m_shine = _shine;
+		m_reflectivity = _reflectivity;
+		m_transparency = _transparency;
+		m_refractiveIndex = _refractiveIndex;
+	}
+
+	bool Scatters() const
+	{
+		return m_reflectivity > 0.0f || m_transparency > 0.0f;
+	}
+};
+
+#endif // _MATERIAL_H_
\ No newline at end of file
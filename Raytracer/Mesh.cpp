@@ -0,0 +1,49 @@
+/// @file Mesh.cpp
+/// @brief Handles mesh parameters and hands the triangles to the FlatScene, which traces them with the rest of the scene
+
+#include <glm.hpp>
+
+#include "FlatScene.h"
+#include "Mesh.h"
+
+Mesh::Mesh()
+{
+	//Mesh defaults
+	m_position = glm::vec3(0, 0, 0);
+}
+
+Mesh::Mesh(int _material)
+{
+	//Create mesh with specific parameters, triangles are added afterwards
+	m_position = glm::vec3(0, 0, 0);
+	m_material = _material;
+}
+
+int Mesh::NumberOfTriangles() const
+{
+	return (int)(m_indices.size() / 3);
+}
+
+void Mesh::AddTriangle(unsigned int _a, unsigned int _b, unsigned int _c)
+{
+	m_indices.push_back(_a);
+	m_indices.push_back(_b);
+	m_indices.push_back(_c);
+}
+
+void Mesh::Transform(glm::vec3 _scale, glm::vec3 _translation)
+{
+	for (size_t k = 0; k < m_vertices.size(); ++k)
+	{
+		m_vertices[k] = m_vertices[k] * _scale + _translation;
+	}
+}
+
+void Mesh::Flatten(FlatScene *_scene)
+{
+	//Every triangle becomes its own primitive in the scene's BVH
+	for (int k = 0; k < NumberOfTriangles(); ++k)
+	{
+		_scene->AddTriangle(m_vertices[m_indices[3 * k]], m_vertices[m_indices[3 * k + 1]], m_vertices[m_indices[3 * k + 2]], m_material);
+	}
+}
\ No newline at end of file
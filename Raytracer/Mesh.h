@@ -0,0 +1,30 @@
+/// \file Mesh.h
+/// \brief triangle mesh stored as an indexed vertex buffer, flattened into the scene's BVH triangle by triangle
+/// \author Josh Bailey
+
+#ifndef _MESH_H_
+#define _MESH_H_
+
+//File includes
+#include <vector>
+#include <glm.hpp>
+
+#include "Shape.h"
+
+class Mesh : public Shape	//Inheritance from Shape
+{
+public:
+	//Variables
+	std::vector<glm::vec3> m_vertices;
+	std::vector<unsigned int> m_indices;	//Three per triangle, into m_vertices
+
+	//Functions
+	Mesh();
+	Mesh(int _material);
+	int NumberOfTriangles() const;
+	void AddTriangle(unsigned int _a, unsigned int _b, unsigned int _c);
+	void Transform(glm::vec3 _scale, glm::vec3 _translation);	//Applied to every vertex, call before Flatten
+	void Flatten(FlatScene *_scene);
+};
+
+#endif // _MESH_H_
\ No newline at end of file
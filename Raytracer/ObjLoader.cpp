@@ -0,0 +1,108 @@
+/// @file ObjLoader.cpp
+/// @brief Reads the file in large blocks and parses each line in place, nothing is allocated per vertex or face
+
+#include <cstdlib>
+#include <iostream>
+
+#include "LineReader.h"
+#include "ObjLoader.h"
+
+static const char *SkipSpace(const char *_text)
+{
+	while (*_text == ' ' || *_text == '\t' || *_text == '\r')
+	{
+		++_text;
+	}
+	return _text;
+}
+
+//"f 1 2 3", "f 1/1 2/2 3/3", "f 1//1 2//2 3//3", "f 1/1/1 2/2/2 3/3/3 4/4/4"...
+static bool ParseFace(const char *_text, Mesh &_mesh, unsigned int _lineNumber)
+{
+	long numberOfVertices = (long)_mesh.m_vertices.size();
+	unsigned int first = 0;
+	unsigned int previous = 0;
+	int corners = 0;
+
+	while (true)
+	{
+		_text = SkipSpace(_text);
+		if (*_text == '\0')
+		{
+			break;
+		}
+
+		char *end = nullptr;
+		long index = std::strtol(_text, &end, 10);
+		if (end == _text)
+		{
+			std::cout << "OBJ line " << _lineNumber << ": bad face" << std::endl;
+			return false;
+		}
+
+		//1-based, negative counts back from the most recent vertex
+		index = index < 0 ? numberOfVertices + index : index - 1;
+		if (index < 0 || index >= numberOfVertices)
+		{
+			std::cout << "OBJ line " << _lineNumber << ": face refers to missing vertex" << std::endl;
+			return false;
+		}
+
+		//Texture coordinate and normal indices are skipped
+		_text = end;
+		while (*_text != '\0' && *_text != ' ' && *_text != '\t' && *_text != '\r')
+		{
+			++_text;
+		}
+
+		//Fan around the first corner
+		unsigned int corner = (unsigned int)index;
+		if (corners == 0)
+		{
+			first = corner;
+		}
+		else if (corners >= 2)
+		{
+			_mesh.AddTriangle(first, previous, corner);
+		}
+		previous = corner;
+		++corners;
+	}
+	return true;
+}
+
+bool ParseOBJLine(char *_line, Mesh &_mesh, unsigned int _lineNumber)
+{
+	const char *text = SkipSpace(_line);
+
+	if (text[0] == 'v' && (text[1] == ' ' || text[1] == '\t'))
+	{
+		char *end = nullptr;
+		glm::vec3 vertex;
+		vertex.x = std::strtof(text + 2, &end);
+		vertex.y = std::strtof(end, &end);
+		vertex.z = std::strtof(end, &end);
+		_mesh.m_vertices.push_back(vertex);
+		return true;
+	}
+
+	if (text[0] == 'f' && (text[1] == ' ' || text[1] == '\t'))
+	{
+		return ParseFace(text + 2, _mesh, _lineNumber);
+	}
+
+	//Comments, normals, texture coordinates, groups and materials are not used
+	return true;
+}
+
+bool LoadOBJ(const std::string &_path, Mesh &_mesh)
+{
+	bool valid = ReadLines(_path, [&_mesh](char *_line, unsigned int _lineNumber) { return ParseOBJLine(_line, _mesh, _lineNumber); });
+
+	if (valid && _mesh.NumberOfTriangles() == 0)
+	{
+		std::cout << _path << " has no faces" << std::endl;
+		valid = false;
+	}
+	return valid;
+}
\ No newline at end of file
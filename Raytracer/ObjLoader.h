@@ -0,0 +1,20 @@
+/// \file ObjLoader.h
+/// \brief streams a Wavefront .obj file straight into a Mesh's vertex and index buffers
+/// \author Josh Bailey
+
+#ifndef _OBJLOADER_H_
+#define _OBJLOADER_H_
+
+//File includes
+#include <string>
+
+#include "Mesh.h"
+
+//Reads "v" and "f" lines (polygons become triangle fans, negative indices allowed), everything else is skipped,
+//returns false with a message printed if the file can't be read
+bool LoadOBJ(const std::string &_path, Mesh &_mesh);
+
+//One line of a .obj, also used for meshes written out inside a scene file, false with a message printed if it is bad
+bool ParseOBJLine(char *_line, Mesh &_mesh, unsigned int _lineNumber);
+
+#endif // _OBJLOADER_H_
\ No newline at end of file
@@ -0,0 +1,247 @@
+/// @file PathIntegrator.cpp
+/// @brief Paths through the phong materials, lit by the point lights and the white background
+
+#include <cmath>
+
+#include "PathIntegrator.h"
+#include "Wavefront.h"
+
+static const float pi = 3.14159265358979f;
+static const float rayBias = 1e-3f;		//Start just off the surface on the side the ray leaves from, as shadow rays do
+static const glm::vec3 backgroundRadiance = glm::vec3(1, 1, 1);	//White, as the phong shading's background
+static const float backgroundPdf = 1.0f / (4.0f * pi);			//Background samples are spread evenly over the sphere
+
+//Unit vectors at right angles to _axis and each other - Duff et al, Building an Orthonormal Basis, Revisited
+static void Basis(const glm::vec3 &_axis, glm::vec3 *_tangent, glm::vec3 *_bitangent)
+{
+	float sign = std::copysign(1.0f, _axis.z);
+	float a = -1.0f / (sign + _axis.z);
+	float b = _axis.x * _axis.y * a;
+	*_tangent = glm::vec3(1.0f + sign * _axis.x * _axis.x * a, sign * b, -sign * _axis.x);
+	*_bitangent = glm::vec3(b, sign + _axis.y * _axis.y * a, -_axis.y);
+}
+
+//Direction whose angle to _axis has the given cosine, turned _phi around it
+static glm::vec3 AroundAxis(const glm::vec3 &_axis, float _cosine, float _phi)
+{
+	glm::vec3 tangent;
+	glm::vec3 bitangent;
+	Basis(_axis, &tangent, &bitangent);
+	float sine = std::sqrt(glm::max(0.0f, 1.0f - _cosine * _cosine));
+	return glm::normalize(tangent * (sine * std::cos(_phi)) + bitangent * (sine * std::sin(_phi)) + _axis * _cosine);
+}
+
+//Veach's power heuristic, the share of a sample's contribution given to the strategy with density _pdf
+static float PowerHeuristic(float _pdf, float _otherPdf)
+{
+	float squared = _pdf * _pdf;
+	float otherSquared = _otherPdf * _otherPdf;
+	return squared / (squared + otherSquared);
+}
+
+//A phong material as a reflectance function: a lambertian lobe plus a normalised phong lobe around the mirror
+//direction, scaled down where the two together would reflect more than arrives
+struct PhongLobes
+{
+	//Variables
+	glm::vec3 m_normal;			//On the viewer's side
+	glm::vec3 m_mirror;			//The viewer's direction reflected about m_normal
+	glm::vec3 m_diffuse;
+	glm::vec3 m_specular;
+	float m_exponent;
+	float m_diffuseChance;		//Odds of sampling the lambertian lobe rather than the phong one
+
+	//Functions
+	PhongLobes(const Material &_material, glm::vec3 _normal, glm::vec3 _towardsViewer)
+	{
+		m_normal = _normal;
+		m_mirror = glm::normalize(2.0f * glm::dot(_towardsViewer, _normal) * _normal - _towardsViewer);
+		glm::vec3 albedo = _material.m_diffuse + _material.m_specular;
+		float scale = 1.0f / glm::max(1.0f, glm::max(albedo.x, glm::max(albedo.y, albedo.z)));
+		m_diffuse = _material.m_diffuse * scale;
+		m_specular = _material.m_specular * scale;
+		m_exponent = (float)_material.m_shine;
+
+		float diffuseWeight = m_diffuse.x + m_diffuse.y + m_diffuse.z;
+		float specularWeight = m_specular.x + m_specular.y + m_specular.z;
+		m_diffuseChance = diffuseWeight + specularWeight > 0.0f ? diffuseWeight / (diffuseWeight + specularWeight) : 1.0f;
+	}
+
+	//Light reflected towards the viewer per unit of light arriving along _direction
+	glm::vec3 Evaluate(const glm::vec3 &_direction) const
+	{
+		if (glm::dot(_direction, m_normal) <= 0.0f)
+		{
+			return glm::vec3(0, 0, 0);
+		}
+		float lobe = std::pow(glm::max(0.0f, glm::dot(_direction, m_mirror)), m_exponent);
+		return m_diffuse * (1.0f / pi) + m_specular * ((m_exponent + 2.0f) / (2.0f * pi) * lobe);
+	}
+
+	//Density Sample() gives _direction, over the sphere
+	float Pdf(const glm::vec3 &_direction) const
+	{
+		float cosine = glm::dot(_direction, m_normal);
+		if (cosine <= 0.0f)
+		{
+			return 0.0f;
+		}
+		float lobe = std::pow(glm::max(0.0f, glm::dot(_direction, m_mirror)), m_exponent);
+		return m_diffuseChance * cosine / pi + (1.0f - m_diffuseChance) * (m_exponent + 1.0f) / (2.0f * pi) * lobe;
+	}
+
+	//Cosine weighted about the normal, or about the mirror direction by the phong lobe, which can fall below the surface
+	glm::vec3 Sample(PCG32 &_random) const
+	{
+		float choice = _random.NextFloat();
+		float u = _random.NextFloat();
+		float phi = 2.0f * pi * _random.NextFloat();
+		if (choice < m_diffuseChance)
+		{
+			return AroundAxis(m_normal, std::sqrt(u), phi);
+		}
+		return AroundAxis(m_mirror, std::pow(u, 1.0f / (m_exponent + 1.0f)), phi);
+	}
+};
+
+PathIntegrator::PathIntegrator(const FlatScene &_scene, const SceneDescription &_description, const RenderSettings &_settings) :
+	Integrator(_scene, _description, _settings)
+{
+}
+
+glm::vec3 PathIntegrator::Radiance(const HitRecord &_hit, glm::vec3 _originOfRay, glm::vec3 _directionOfRay, int _pixel, int _sample, long long *_rays)
+{
+	//The wavefront's stages one vertex at a time, shadow rays are traced as soon as they are made
+	static thread_local ShadowQueue shadowRays;
+	QueuedRay ray = CameraRay(_originOfRay, _directionOfRay, _pixel, _sample, 0);
+	HitRecord hit = _hit;
+	glm::vec3 colour = glm::vec3(0, 0, 0);
+	while (true)
+	{
+		shadowRays.Clear();
+		bool continues = Bounce(ray, hit, shadowRays, &colour);
+		Wavefront::Connect(m_scene, shadowRays, m_settings.Shadows(), &colour, _rays);
+		if (!continues)
+		{
+			return colour;
+		}
+		hit = HitRecord();
+		m_scene.Intersection(&hit, ray.m_origin, ray.m_direction);
+		++*_rays;
+	}
+}
+
+void PathIntegrator::Shade(const QueuedRay &_ray, const HitRecord &_hit, RayQueue &_bounces, ShadowQueue &_shadowRays, glm::vec3 *_colours)
+{
+	QueuedRay ray = _ray;
+	if (Bounce(ray, _hit, _shadowRays, _colours))
+	{
+		_bounces.Push(ray);
+	}
+}
+
+bool PathIntegrator::Bounce(QueuedRay &_ray, const HitRecord &_hit, ShadowQueue &_shadowRays, glm::vec3 *_colours)
+{
+	//m_pdf is 0 for camera, mirror and glass rays, which the background sampling can't make
+	if (!_hit.Hit())
+	{
+		float weight = _ray.m_pdf > 0.0f ? PowerHeuristic(_ray.m_pdf, backgroundPdf) : 1.0f;
+		_colours[_ray.m_pixel] += _ray.m_weight * backgroundRadiance * weight;
+		return false;
+	}
+
+	const Material &material = m_scene.MaterialOf(_hit);
+	glm::vec3 p0 = _ray.m_origin + (_hit.m_t * _ray.m_direction);
+	glm::vec3 normal = glm::normalize(m_scene.Normal(_hit, p0));
+
+	//Mirror and glass reflect, refract or show the phong surface beneath, picked by the share of light each takes so
+	//the weight carries only the tint
+	if (material.Scatters())
+	{
+		SurfaceSplit split = Split(material, _ray.m_direction, normal);
+		float refracted = split.m_refracts ? (1.0f - split.m_fresnel) * material.m_transparency : 0.0f;
+		float choice = _ray.m_random.NextFloat();
+		if (choice < split.m_fresnel + refracted)
+		{
+			if (choice < split.m_fresnel)
+			{
+				_ray.m_weight *= material.m_specular;
+				_ray.m_origin = p0 + split.m_normal * rayBias;
+				_ray.m_direction = split.m_reflected;
+			}
+			else
+			{
+				_ray.m_origin = p0 - split.m_normal * rayBias;
+				_ray.m_direction = split.m_refracted;
+			}
+			_ray.m_pdf = 0.0f;
+			++_ray.m_depth;
+			return _ray.m_depth <= m_settings.MaxDepth() && Survives(&_ray.m_weight, _ray.m_random);
+		}
+	}
+
+	glm::vec3 towardsViewer = -_ray.m_direction;
+	if (glm::dot(normal, towardsViewer) < 0.0f)
+	{
+		normal = -normal;	//Planes and triangles seen from behind
+	}
+	PhongLobes lobes(material, normal, towardsViewer);
+	glm::vec3 shadowOrigin = p0 + normal * rayBias;
+
+	//Next event estimation
+	PointLights(lobes, p0, shadowOrigin, _ray, _shadowRays);
+	Background(lobes, shadowOrigin, _ray, _shadowRays);
+	if (_ray.m_depth == m_settings.MaxDepth())
+	{
+		return false;
+	}
+
+	glm::vec3 direction = lobes.Sample(_ray.m_random);
+	float cosine = glm::dot(normal, direction);
+	float pdf = lobes.Pdf(direction);
+	if (cosine <= 0.0f || pdf <= 0.0f)
+	{
+		return false;
+	}
+	_ray.m_weight *= lobes.Evaluate(direction) * (cosine / pdf);
+	_ray.m_origin = shadowOrigin;
+	_ray.m_direction = direction;
+	_ray.m_pdf = pdf;
+	++_ray.m_depth;
+	return Survives(&_ray.m_weight, _ray.m_random);
+}
+
+void PathIntegrator::PointLights(const PhongLobes &_lobes, glm::vec3 _p0, glm::vec3 _shadowOrigin, const QueuedRay &_ray, ShadowQueue &_shadowRays)
+{
+	//Intensity is the light a surface facing the light receives, at any distance, as in the phong shading, so a white
+	//lambertian surface looks the same under either integrator
+	for (const Light &light : m_description.m_lights)
+	{
+		glm::vec3 rayOfLight = glm::normalize(light.m_position - _p0);
+		float cosine = glm::dot(rayOfLight, _lobes.m_normal);
+		if (cosine <= 0.0f)
+		{
+			continue;
+		}
+		float distanceToLight = glm::length(light.m_position - _shadowOrigin);
+		glm::vec3 contribution = _ray.m_weight * (pi * _lobes.Evaluate(rayOfLight) * light.m_intensity * cosine);
+		_shadowRays.Push(_shadowOrigin, (light.m_position - _shadowOrigin) / distanceToLight, distanceToLight, contribution, _ray.m_pixel);
+	}
+}
+
+void PathIntegrator::Background(const PhongLobes &_lobes, glm::vec3 _shadowOrigin, QueuedRay &_ray, ShadowQueue &_shadowRays)
+{
+	float z = 1.0f - 2.0f * _ray.m_random.NextFloat();
+	float phi = 2.0f * pi * _ray.m_random.NextFloat();
+	float radius = std::sqrt(glm::max(0.0f, 1.0f - z * z));
+	glm::vec3 direction = glm::vec3(radius * std::cos(phi), radius * std::sin(phi), z);
+
+	float cosine = glm::dot(direction, _lobes.m_normal);
+	if (cosine <= 0.0f)
+	{
+		return;
+	}
+	float weight = PowerHeuristic(backgroundPdf, _lobes.Pdf(direction));
+	glm::vec3 contribution = _ray.m_weight * (_lobes.Evaluate(direction) * backgroundRadiance * (cosine * weight / backgroundPdf));
+	_shadowRays.Push(_shadowOrigin, direction, INFINITY, contribution, _ray.m_pixel);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+/// \file PathIntegrator.h
+/// \brief monte carlo path tracer with next event estimation and multiple importance sampling, the final quality mode
+/// \author Josh Bailey
+
+#ifndef _PATHINTEGRATOR_H_
+#define _PATHINTEGRATOR_H_
+
+//File includes
+#include "Integrator.h"
+
+struct PhongLobes;
+
+//Each hit is lit by aiming shadow rays at the point lights and at a random point of the white background, then the path
+//carries on along the material's own lobes. The background can be found either way, so the two are weighted by the
+//power heuristic, point lights can only be aimed at. Mirror and glass are picked between by Fresnel, as whole events.
+class PathIntegrator : public Integrator
+{
+public:
+	//Functions
+	PathIntegrator(const FlatScene &_scene, const SceneDescription &_description, const RenderSettings &_settings);
+	glm::vec3 Radiance(const HitRecord &_hit, glm::vec3 _originOfRay, glm::vec3 _directionOfRay, int _pixel, int _sample, long long *_rays) override;
+	void Shade(const QueuedRay &_ray, const HitRecord &_hit, RayQueue &_bounces, ShadowQueue &_shadowRays, glm::vec3 *_colours) override;
+
+private:
+	//Functions
+	//One vertex of the path, what it adds straight away goes into _colours and what depends on a shadow ray into
+	//_shadowRays, false once the path has ended, else _ray is the next one to trace
+	bool Bounce(QueuedRay &_ray, const HitRecord &_hit, ShadowQueue &_shadowRays, glm::vec3 *_colours);
+	void PointLights(const PhongLobes &_lobes, glm::vec3 _p0, glm::vec3 _shadowOrigin, const QueuedRay &_ray, ShadowQueue &_shadowRays);	//Light arriving from every point light, through the lobes
+	void Background(const PhongLobes &_lobes, glm::vec3 _shadowOrigin, QueuedRay &_ray, ShadowQueue &_shadowRays);		//One background sample, weighted against finding it through the lobes
+};
+
+#endif // _PATHINTEGRATOR_H_
\ No newline at end of file
@@ -0,0 +1,55 @@
+/// \file PixelEstimate.h
+/// \brief running mean and variance of one pixel's samples, kept between passes so a render can carry on where it stopped
+/// \author Josh Bailey
+
+#ifndef _PIXELESTIMATE_H_
+#define _PIXELESTIMATE_H_
+
+//File includes
+#include <cmath>
+#include <glm.hpp>
+
+//32 bytes, one per pixel of the image
+struct PixelEstimate
+{
+	//Variables
+	glm::vec3 m_mean;
+	glm::vec3 m_squaredDifferences;	//Sum of squared differences from the mean (Welford), the variance without the division
+	float m_squaredError;			//Squared standard error of the noisiest channel, infinite until there are enough samples to trust it
+	int m_samples;					//Samples taken, negative once the pixel has converged and takes no more
+
+	//Functions
+	PixelEstimate()
+	{
+		m_mean = glm::vec3(0, 0, 0);
+		m_squaredDifferences = glm::vec3(0, 0, 0);
+		m_squaredError = INFINITY;
+		m_samples = 0;
+	}
+
+	int Samples() const
+	{
+		return m_samples < 0 ? -m_samples : m_samples;
+	}
+
+	bool Converged() const
+	{
+		return m_samples < 0;
+	}
+
+	void Converge()
+	{
+		m_samples = -Samples();
+	}
+
+	//Welford's update, stable however many samples are added
+	void Add(glm::vec3 _sample)
+	{
+		++m_samples;
+		glm::vec3 delta = _sample - m_mean;
+		m_mean += delta / (float)m_samples;
+		m_squaredDifferences += delta * (_sample - m_mean);
+	}
+};
+
+#endif // _PIXELESTIMATE_H_
\ No newline at end of file
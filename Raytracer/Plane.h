@@ -18,9 +18,8 @@ public:
 	
 	//Functions
 	Plane();
-	Plane(glm::vec3 _position, glm::vec3 _normal, glm::vec3 _colour);
-	bool Intersection(float *_t, glm::vec3 _originOfRay, glm::vec3 _directionOfRay);
-	glm::vec3 NormalCalculation(glm::vec3 _p0, int *_shine, glm::vec3* _colourOfDiffuse, glm::vec3 *_colourOfSpecular);
+	Plane(glm::vec3 _position, glm::vec3 _normal, int _material);
+	void Flatten(FlatScene *_scene);
 };
 
 #endif //_PLANE_H_
\ No newline at end of file
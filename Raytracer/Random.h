@@ -0,0 +1,47 @@
+/// \file Random.h
+/// \brief small fast PCG32 generator, cheap enough to seed a fresh stream for every pixel sample
+/// \author Josh Bailey
+
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+//File includes
+#include <cstdint>
+
+//PCG32 (XSH RR) - http://www.pcg-random.org, 16 bytes of state, no locks or shared state between threads
+class PCG32
+{
+public:
+	//Functions
+	PCG32(uint64_t _seed, uint64_t _stream)
+	{
+		//Initialisation from the reference implementation, each stream is an independent sequence
+		m_state = 0u;
+		m_increment = (_stream << 1u) | 1u;
+		Next();
+		m_state += _seed;
+		Next();
+	}
+
+	uint32_t Next()
+	{
+		uint64_t previous = m_state;
+		m_state = previous * 6364136223846793005ULL + m_increment;
+		uint32_t xorShifted = (uint32_t)(((previous >> 18u) ^ previous) >> 27u);
+		uint32_t rotation = (uint32_t)(previous >> 59u);
+		return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31u));
+	}
+
+	//Uniform in [0, 1), the top 24 bits so every value is exactly representable
+	float NextFloat()
+	{
+		return (Next() >> 8) * (1.0f / 16777216.0f);
+	}
+
+private:
+	//Variables
+	uint64_t m_state;
+	uint64_t m_increment;
+};
+
+#endif // _RANDOM_H_
\ No newline at end of file
@@ -0,0 +1,303 @@
+/// @file RayPacket.cpp
+/// @brief Traces a 4x4 packet of primary rays, one BVH traversal shared by all 16 rays instead of 16 separate ones
+
+#include <cmath>
+
+#include "RayPacket.h"
+
+#ifdef RAYPACKET_SIMD
+#include <emmintrin.h>
+#endif
+
+RayPacket::RayPacket()
+{
+	Reset(glm::vec3(0, 0, 0));
+}
+
+void RayPacket::Reset(glm::vec3 _origin)
+{
+	m_origin = _origin;
+	m_count = 0;
+
+	//Unused rays point somewhere harmless and can never record a hit
+	for (int r = 0; r < packetSize; ++r)
+	{
+		m_directionX[r] = 0.0f;
+		m_directionY[r] = 0.0f;
+		m_directionZ[r] = -1.0f;
+		m_minT[r] = -INFINITY;
+		m_hitPrimitive[r] = -1;
+		m_hitUV[r] = glm::vec2(0, 0);
+		m_pixelX[r] = 0;
+		m_pixelY[r] = 0;
+	}
+}
+
+void RayPacket::AddRay(int _i, int _j, glm::vec3 _directionOfRay)
+{
+	m_directionX[m_count] = _directionOfRay.x;
+	m_directionY[m_count] = _directionOfRay.y;
+	m_directionZ[m_count] = _directionOfRay.z;
+	m_minT[m_count] = INFINITY;
+	m_hitPrimitive[m_count] = -1;
+	m_hitUV[m_count] = glm::vec2(0, 0);
+	m_pixelX[m_count] = _i;
+	m_pixelY[m_count] = _j;
+	++m_count;
+}
+
+glm::vec3 RayPacket::Direction(int _ray) const
+{
+	return glm::vec3(m_directionX[_ray], m_directionY[_ray], m_directionZ[_ray]);
+}
+
+HitRecord RayPacket::Hit(int _ray) const
+{
+	HitRecord hit;
+	hit.m_t = m_minT[_ray];
+	hit.m_primitive = m_hitPrimitive[_ray];
+	hit.m_uv = m_hitUV[_ray];
+	return hit;
+}
+
+void RayPacket::Intersection(const FlatScene &_scene)
+{
+	const BVH &bvh = _scene.m_bvh;
+
+	//Planes are cheap and few, test them ray by ray
+	for (int r = 0; r < m_count; ++r)
+	{
+		glm::vec3 directionOfRay = Direction(r);
+		HitRecord hit = Hit(r);
+		for (int k = 0; k < (int)_scene.m_planes.size(); ++k)
+		{
+			_scene.IntersectionPlane(&hit, k, m_origin, directionOfRay);
+		}
+		SetHit(r, hit);
+	}
+
+	if (bvh.Empty() || m_count == 0)
+	{
+		return;
+	}
+
+	alignas(16) float inverseX[packetSize];
+	alignas(16) float inverseY[packetSize];
+	alignas(16) float inverseZ[packetSize];
+	glm::vec3 inverseMin = glm::vec3(INFINITY, INFINITY, INFINITY);
+	glm::vec3 inverseMax = glm::vec3(-INFINITY, -INFINITY, -INFINITY);
+	glm::vec3 meanDirection = glm::vec3(0, 0, 0);
+	for (int r = 0; r < packetSize; ++r)
+	{
+		inverseX[r] = 1.0f / m_directionX[r];
+		inverseY[r] = 1.0f / m_directionY[r];
+		inverseZ[r] = 1.0f / m_directionZ[r];
+		if (r < m_count)
+		{
+			glm::vec3 inverse = glm::vec3(inverseX[r], inverseY[r], inverseZ[r]);
+			inverseMin = glm::min(inverseMin, inverse);
+			inverseMax = glm::max(inverseMax, inverse);
+			meanDirection += Direction(r);
+		}
+	}
+
+	//Interval test only holds when every ray heads the same way along each axis
+	bool useInterval = true;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (!std::isfinite(inverseMin[axis]) || !std::isfinite(inverseMax[axis]) || (inverseMin[axis] < 0.0f && inverseMax[axis] > 0.0f))
+		{
+			useInterval = false;
+		}
+	}
+
+	//Every push is followed by a pop before the next level, so depth + 2 entries is enough
+	int stack[128];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const BVHNode &node = bvh.m_nodes[stack[--stackSize]];
+
+		//Furthest any ray still needs to look
+		float maxT = -INFINITY;
+		for (int r = 0; r < m_count; ++r)
+		{
+			maxT = glm::max(maxT, m_minT[r]);
+		}
+
+		//Whole packet misses, decided from its bounds alone
+		if (useInterval && IntervalMiss(node.m_bounds, inverseMin, inverseMax, maxT))
+		{
+			continue;
+		}
+
+		//Otherwise at least one ray has to hit the box
+		bool anyHit = false;
+#ifdef RAYPACKET_SIMD
+		glm::vec3 nearCorner = node.m_bounds.m_min - m_origin;
+		glm::vec3 farCorner = node.m_bounds.m_max - m_origin;
+		const __m128 minX = _mm_set1_ps(nearCorner.x);
+		const __m128 minY = _mm_set1_ps(nearCorner.y);
+		const __m128 minZ = _mm_set1_ps(nearCorner.z);
+		const __m128 maxX = _mm_set1_ps(farCorner.x);
+		const __m128 maxY = _mm_set1_ps(farCorner.y);
+		const __m128 maxZ = _mm_set1_ps(farCorner.z);
+		for (int r = 0; r < packetSize && !anyHit; r += 4)
+		{
+			__m128 ix = _mm_load_ps(inverseX + r);
+			__m128 iy = _mm_load_ps(inverseY + r);
+			__m128 iz = _mm_load_ps(inverseZ + r);
+			__m128 t0x = _mm_mul_ps(minX, ix);
+			__m128 t1x = _mm_mul_ps(maxX, ix);
+			__m128 t0y = _mm_mul_ps(minY, iy);
+			__m128 t1y = _mm_mul_ps(maxY, iy);
+			__m128 t0z = _mm_mul_ps(minZ, iz);
+			__m128 t1z = _mm_mul_ps(maxZ, iz);
+			__m128 tEnter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)), _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+			__m128 tExit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)), _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_load_ps(m_minT + r)));
+			anyHit = _mm_movemask_ps(_mm_cmple_ps(tEnter, tExit)) != 0;
+		}
+#else
+		for (int r = 0; r < m_count && !anyHit; ++r)
+		{
+			float tNear = 0.0f;
+			anyHit = node.m_bounds.Intersection(&tNear, m_origin, glm::vec3(inverseX[r], inverseY[r], inverseZ[r]), m_minT[r]);
+		}
+#endif
+		if (!anyHit)
+		{
+			continue;
+		}
+
+		if (node.m_count > 0)
+		{
+			IntersectionLeaf(_scene, node.m_leftOrFirst, node.m_count);
+			continue;
+		}
+
+		//Push the further child first so the nearer one (along the packet's average direction) is popped next
+		int left = node.m_leftOrFirst;
+		int right = left + 1;
+		glm::vec3 separation = bvh.m_nodes[right].m_bounds.Centroid() - bvh.m_nodes[left].m_bounds.Centroid();
+		if (glm::dot(separation, meanDirection) < 0.0f)
+		{
+			std::swap(left, right);
+		}
+		stack[stackSize++] = right;
+		stack[stackSize++] = left;
+	}
+}
+
+void RayPacket::IntersectionLeaf(const FlatScene &_scene, int _first, int _count)
+{
+	const SphereSet &spheres = _scene.m_spheres;
+
+#ifdef RAYPACKET_SIMD
+	//One sphere against four rays at a time, same arithmetic as SphereSet::Intersection
+	for (int slot = _first; slot < _first + _count; ++slot)
+	{
+		if (spheres.m_material[slot] == -1)
+		{
+			continue;
+		}
+		float lxScalar = spheres.m_centreX[slot] - m_origin.x;
+		float lyScalar = spheres.m_centreY[slot] - m_origin.y;
+		float lzScalar = spheres.m_centreZ[slot] - m_origin.z;
+		const __m128 lx = _mm_set1_ps(lxScalar);
+		const __m128 ly = _mm_set1_ps(lyScalar);
+		const __m128 lz = _mm_set1_ps(lzScalar);
+		const __m128 lengthSquared = _mm_set1_ps(lxScalar * lxScalar + lyScalar * lyScalar + lzScalar * lzScalar);
+		const __m128 radiusSquared = _mm_set1_ps(spheres.m_radiusSquared[slot]);
+
+		for (int r = 0; r < packetSize; r += 4)
+		{
+			__m128 tca = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, _mm_load_ps(m_directionX + r)), _mm_mul_ps(ly, _mm_load_ps(m_directionY + r))), _mm_mul_ps(lz, _mm_load_ps(m_directionZ + r)));
+			__m128 s2 = _mm_sub_ps(lengthSquared, _mm_mul_ps(tca, tca));
+			__m128 thc = _mm_sqrt_ps(_mm_sub_ps(radiusSquared, s2));
+			__m128 t = _mm_sub_ps(tca, thc);
+			__m128 inside = _mm_cmplt_ps(t, _mm_setzero_ps());
+			t = _mm_or_ps(_mm_and_ps(inside, _mm_add_ps(tca, thc)), _mm_andnot_ps(inside, t));
+			__m128 minT = _mm_load_ps(m_minT + r);
+
+			__m128 hit = _mm_and_ps(_mm_cmpge_ps(t, _mm_setzero_ps()), _mm_cmple_ps(s2, radiusSquared));
+			hit = _mm_and_ps(hit, _mm_cmplt_ps(t, minT));
+
+			int mask = _mm_movemask_ps(hit);
+			if (mask != 0)
+			{
+				_mm_store_ps(m_minT + r, _mm_or_ps(_mm_and_ps(hit, t), _mm_andnot_ps(hit, minT)));
+				for (int lane = 0; lane < 4; ++lane)
+				{
+					if ((mask >> lane) & 1)
+					{
+						m_hitPrimitive[r + lane] = FlatScene::Reference(FlatScene::primitiveSphere, slot);
+						m_hitUV[r + lane] = glm::vec2(0, 0);
+					}
+				}
+			}
+		}
+	}
+	if (_scene.m_allSpheres)
+	{
+		return;
+	}
+#endif
+
+	//Triangles and mapped meshes in the leaf (or everything without SSE), one ray at a time
+	for (int r = 0; r < m_count; ++r)
+	{
+		glm::vec3 directionOfRay = Direction(r);
+		HitRecord hit = Hit(r);
+		for (int k = _first; k < _first + _count; ++k)
+		{
+			int reference = _scene.m_bvh.m_primitives[k];
+			if (FlatScene::Type(reference) == FlatScene::primitiveTriangle)
+			{
+				_scene.IntersectionTriangle(&hit, FlatScene::Index(reference), m_origin, directionOfRay);
+			}
+			else if (FlatScene::Type(reference) == FlatScene::primitiveMappedMesh)
+			{
+				_scene.IntersectionMappedMesh(&hit, FlatScene::Index(reference), m_origin, directionOfRay);
+			}
+#ifndef RAYPACKET_SIMD
+			else
+			{
+				int slot = -1;
+				if (spheres.Intersection(&hit.m_t, &slot, m_origin, directionOfRay, k, 1, hit.m_t))
+				{
+					hit.m_primitive = reference;
+					hit.m_uv = glm::vec2(0, 0);
+				}
+			}
+#endif
+		}
+		SetHit(r, hit);
+	}
+}
+
+void RayPacket::SetHit(int _ray, const HitRecord &_hit)
+{
+	m_minT[_ray] = _hit.m_t;
+	m_hitPrimitive[_ray] = _hit.m_primitive;
+	m_hitUV[_ray] = _hit.m_uv;
+}
+
+bool RayPacket::IntervalMiss(const AABB &_bounds, const glm::vec3 &_inverseMin, const glm::vec3 &_inverseMax, float _maxT) const
+{
+	//Interval arithmetic slab test: the earliest any ray could enter against the latest any ray could leave
+	float enter = 0.0f;
+	float exit = _maxT;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		bool positive = _inverseMin[axis] > 0.0f;
+		float nearPlane = (positive ? _bounds.m_min[axis] : _bounds.m_max[axis]) - m_origin[axis];
+		float farPlane = (positive ? _bounds.m_max[axis] : _bounds.m_min[axis]) - m_origin[axis];
+		float nearLow = glm::min(nearPlane * _inverseMin[axis], nearPlane * _inverseMax[axis]);
+		float farHigh = glm::max(farPlane * _inverseMin[axis], farPlane * _inverseMax[axis]);
+		enter = glm::max(enter, nearLow);
+		exit = glm::min(exit, farHigh);
+	}
+	return enter > exit;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+/// \file RayPacket.h
+/// \brief 4x4 block of primary rays sharing an origin, traced through the BVH together with SSE lanes across rays
+/// \author Josh Bailey
+
+#ifndef _RAYPACKET_H_
+#define _RAYPACKET_H_
+
+//File includes
+#include <glm.hpp>
+
+#include "FlatScene.h"
+#include "HitRecord.h"
+
+//Packets need SSE, otherwise primary rays are traced one at a time
+#if defined(SPHERESET_SSE) || defined(SPHERESET_AVX)
+#define RAYPACKET_SIMD
+#endif
+
+class RayPacket
+{
+public:
+	//Variables
+	static const int packetWidth = 4;				//Pixels across and down
+	static const int packetSize = packetWidth * packetWidth;
+
+	//Directions and results in structure of arrays form, 4 rays per SSE register
+	alignas(16) float m_directionX[packetSize];
+	alignas(16) float m_directionY[packetSize];
+	alignas(16) float m_directionZ[packetSize];
+	alignas(16) float m_minT[packetSize];		//Closest hit per ray, -INFINITY marks an unused ray so it can never hit
+	int m_hitPrimitive[packetSize];			//Tagged FlatScene primitive, -1 for a miss
+	glm::vec2 m_hitUV[packetSize];
+	int m_pixelX[packetSize];
+	int m_pixelY[packetSize];
+	glm::vec3 m_origin;
+	int m_count;
+
+	//Functions
+	RayPacket();
+	void Reset(glm::vec3 _origin);
+	void AddRay(int _i, int _j, glm::vec3 _directionOfRay);
+	glm::vec3 Direction(int _ray) const;
+	HitRecord Hit(int _ray) const;		//Closest hit of one ray, gathered from the arrays for shading
+
+	//Closest hit for every ray, planes are tested ray by ray
+	void Intersection(const FlatScene &_scene);
+
+private:
+	//Functions
+	void IntersectionLeaf(const FlatScene &_scene, int _first, int _count);
+	void SetHit(int _ray, const HitRecord &_hit);
+	bool IntervalMiss(const AABB &_bounds, const glm::vec3 &_inverseMin, const glm::vec3 &_inverseMax, float _maxT) const;
+};
+
+#endif // _RAYPACKET_H_
\ No newline at end of file
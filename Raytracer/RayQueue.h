@@ -0,0 +1,193 @@
+/// \file RayQueue.h
+/// \brief rays waiting for a wavefront stage, one array per component so each stage loops over contiguous values
+/// \author Josh Bailey
+
+#ifndef _RAYQUEUE_H_
+#define _RAYQUEUE_H_
+
+//File includes
+#include <vector>
+#include <glm.hpp>
+
+#include "HitRecord.h"
+#include "Random.h"
+
+//One ray and what the integrator carries along it, as it goes in and out of a RayQueue
+struct QueuedRay
+{
+	//Variables
+	glm::vec3 m_origin;
+	glm::vec3 m_direction;
+	glm::vec3 m_weight;		//Share of what the ray finds that reaches its pixel
+	float m_pdf;			//Density the direction was sampled with, 0 where nothing else could have chosen it
+	int m_depth;			//Bounces taken to get here, the camera ray is 0
+	int m_pixel;			//Index into the colours the wavefront accumulates
+	PCG32 m_random;			//The path's own stream, carried from stage to stage
+
+	//Functions
+	QueuedRay() : m_random(0, 0)
+	{
+		m_origin = glm::vec3(0, 0, 0);
+		m_direction = glm::vec3(0, 0, 0);
+		m_weight = glm::vec3(1, 1, 1);
+		m_pdf = 0.0f;
+		m_depth = 0;
+		m_pixel = 0;
+	}
+};
+
+class RayQueue
+{
+public:
+	//Variables
+	std::vector<float> m_originX;
+	std::vector<float> m_originY;
+	std::vector<float> m_originZ;
+	std::vector<float> m_directionX;
+	std::vector<float> m_directionY;
+	std::vector<float> m_directionZ;
+	std::vector<float> m_weightR;
+	std::vector<float> m_weightG;
+	std::vector<float> m_weightB;
+	std::vector<float> m_pdf;
+	std::vector<int> m_depth;
+	std::vector<int> m_pixel;
+	std::vector<PCG32> m_random;
+	std::vector<HitRecord> m_hits;		//Closest hit of each ray, filled in by the extend stage
+
+	//Functions
+	int Size() const
+	{
+		return (int)m_pixel.size();
+	}
+
+	void Clear()
+	{
+		m_originX.clear();
+		m_originY.clear();
+		m_originZ.clear();
+		m_directionX.clear();
+		m_directionY.clear();
+		m_directionZ.clear();
+		m_weightR.clear();
+		m_weightG.clear();
+		m_weightB.clear();
+		m_pdf.clear();
+		m_depth.clear();
+		m_pixel.clear();
+		m_random.clear();
+		m_hits.clear();
+	}
+
+	void Push(const QueuedRay &_ray)
+	{
+		m_originX.push_back(_ray.m_origin.x);
+		m_originY.push_back(_ray.m_origin.y);
+		m_originZ.push_back(_ray.m_origin.z);
+		m_directionX.push_back(_ray.m_direction.x);
+		m_directionY.push_back(_ray.m_direction.y);
+		m_directionZ.push_back(_ray.m_direction.z);
+		m_weightR.push_back(_ray.m_weight.r);
+		m_weightG.push_back(_ray.m_weight.g);
+		m_weightB.push_back(_ray.m_weight.b);
+		m_pdf.push_back(_ray.m_pdf);
+		m_depth.push_back(_ray.m_depth);
+		m_pixel.push_back(_ray.m_pixel);
+		m_random.push_back(_ray.m_random);
+		m_hits.push_back(HitRecord());
+	}
+
+	QueuedRay Ray(int _index) const
+	{
+		QueuedRay ray;
+		ray.m_origin = Origin(_index);
+		ray.m_direction = Direction(_index);
+		ray.m_weight = glm::vec3(m_weightR[_index], m_weightG[_index], m_weightB[_index]);
+		ray.m_pdf = m_pdf[_index];
+		ray.m_depth = m_depth[_index];
+		ray.m_pixel = m_pixel[_index];
+		ray.m_random = m_random[_index];
+		return ray;
+	}
+
+	glm::vec3 Origin(int _index) const
+	{
+		return glm::vec3(m_originX[_index], m_originY[_index], m_originZ[_index]);
+	}
+
+	glm::vec3 Direction(int _index) const
+	{
+		return glm::vec3(m_directionX[_index], m_directionY[_index], m_directionZ[_index]);
+	}
+};
+
+//Shadow rays for the connect stage, each adds its contribution to its pixel if nothing is in the way
+class ShadowQueue
+{
+public:
+	//Variables
+	std::vector<float> m_originX;
+	std::vector<float> m_originY;
+	std::vector<float> m_originZ;
+	std::vector<float> m_directionX;
+	std::vector<float> m_directionY;
+	std::vector<float> m_directionZ;
+	std::vector<float> m_maxT;			//Distance to the light, INFINITY for the background
+	std::vector<float> m_contributionR;
+	std::vector<float> m_contributionG;
+	std::vector<float> m_contributionB;
+	std::vector<int> m_pixel;
+
+	//Functions
+	int Size() const
+	{
+		return (int)m_pixel.size();
+	}
+
+	void Clear()
+	{
+		m_originX.clear();
+		m_originY.clear();
+		m_originZ.clear();
+		m_directionX.clear();
+		m_directionY.clear();
+		m_directionZ.clear();
+		m_maxT.clear();
+		m_contributionR.clear();
+		m_contributionG.clear();
+		m_contributionB.clear();
+		m_pixel.clear();
+	}
+
+	void Push(const glm::vec3 &_origin, const glm::vec3 &_direction, float _maxT, const glm::vec3 &_contribution, int _pixel)
+	{
+		m_originX.push_back(_origin.x);
+		m_originY.push_back(_origin.y);
+		m_originZ.push_back(_origin.z);
+		m_directionX.push_back(_direction.x);
+		m_directionY.push_back(_direction.y);
+		m_directionZ.push_back(_direction.z);
+		m_maxT.push_back(_maxT);
+		m_contributionR.push_back(_contribution.r);
+		m_contributionG.push_back(_contribution.g);
+		m_contributionB.push_back(_contribution.b);
+		m_pixel.push_back(_pixel);
+	}
+
+	glm::vec3 Origin(int _index) const
+	{
+		return glm::vec3(m_originX[_index], m_originY[_index], m_originZ[_index]);
+	}
+
+	glm::vec3 Direction(int _index) const
+	{
+		return glm::vec3(m_directionX[_index], m_directionY[_index], m_directionZ[_index]);
+	}
+
+	glm::vec3 Contribution(int _index) const
+	{
+		return glm::vec3(m_contributionR[_index], m_contributionG[_index], m_contributionB[_index]);
+	}
+};
+
+#endif // _RAYQUEUE_H_
\ No newline at end of file
@@ -0,0 +1,86 @@
+/// @file RaySorter.cpp
+/// @brief Morton keys and an 8 bit radix sort over them
+
+#include <cmath>
+#include <glm.hpp>
+
+#include "RaySorter.h"
+
+static const int bitsPerAxis = 9;		//512 cells along each side of the origins' bounds
+static const int radixBits = 8;
+static const int radixSize = 1 << radixBits;
+
+//Spreads the low 9 bits of _value out to every third bit
+static uint32_t SpreadBits(uint32_t _value)
+{
+	_value &= 0x1ffu;
+	_value = (_value | (_value << 16)) & 0x030000ffu;
+	_value = (_value | (_value << 8)) & 0x0300f00fu;
+	_value = (_value | (_value << 4)) & 0x030c30c3u;
+	_value = (_value | (_value << 2)) & 0x09249249u;
+	return _value;
+}
+
+void RaySorter::Sort(const float *_originX, const float *_originY, const float *_originZ, const float *_directionX, const float *_directionY, const float *_directionZ, int _count)
+{
+	m_keys.resize(_count);
+	m_sortedKeys.resize(_count);
+	m_order.resize(_count);
+	m_sortedOrder.resize(_count);
+	if (_count == 0)
+	{
+		return;
+	}
+
+	//Bounds of this batch's origins rather than the scene's, planes reach past the BVH and bounces cluster anyway
+	glm::vec3 lower = glm::vec3(INFINITY, INFINITY, INFINITY);
+	glm::vec3 upper = glm::vec3(-INFINITY, -INFINITY, -INFINITY);
+	for (int r = 0; r < _count; ++r)
+	{
+		glm::vec3 origin = glm::vec3(_originX[r], _originY[r], _originZ[r]);
+		lower = glm::min(lower, origin);
+		upper = glm::max(upper, origin);
+	}
+	const float cells = (float)((1 << bitsPerAxis) - 1);
+	glm::vec3 scale = cells / glm::max(upper - lower, glm::vec3(1e-6f));
+
+	for (int r = 0; r < _count; ++r)
+	{
+		uint32_t cellX = (uint32_t)((_originX[r] - lower.x) * scale.x);
+		uint32_t cellY = (uint32_t)((_originY[r] - lower.y) * scale.y);
+		uint32_t cellZ = (uint32_t)((_originZ[r] - lower.z) * scale.z);
+		uint32_t octant = (uint32_t)(_directionX[r] < 0.0f) | ((uint32_t)(_directionY[r] < 0.0f) << 1) | ((uint32_t)(_directionZ[r] < 0.0f) << 2);
+		m_keys[r] = (octant << (3 * bitsPerAxis)) | (SpreadBits(cellZ) << 2) | (SpreadBits(cellY) << 1) | SpreadBits(cellX);
+		m_order[r] = r;
+	}
+
+	//Least significant digit first, each pass stable, a digit every key shares is skipped
+	for (int shift = 0; shift < 3 * bitsPerAxis + 3; shift += radixBits)
+	{
+		int counts[radixSize] = {};
+		for (int r = 0; r < _count; ++r)
+		{
+			++counts[(m_keys[r] >> shift) & (radixSize - 1)];
+		}
+		if (counts[(m_keys[0] >> shift) & (radixSize - 1)] == _count)
+		{
+			continue;
+		}
+
+		int offset = 0;
+		for (int digit = 0; digit < radixSize; ++digit)
+		{
+			int count = counts[digit];
+			counts[digit] = offset;
+			offset += count;
+		}
+		for (int r = 0; r < _count; ++r)
+		{
+			int slot = counts[(m_keys[r] >> shift) & (radixSize - 1)]++;
+			m_sortedKeys[slot] = m_keys[r];
+			m_sortedOrder[slot] = m_order[r];
+		}
+		m_keys.swap(m_sortedKeys);
+		m_order.swap(m_sortedOrder);
+	}
+}
\ No newline at end of file
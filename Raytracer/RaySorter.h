@@ -0,0 +1,31 @@
+/// \file RaySorter.h
+/// \brief orders a queue of rays by direction octant then by a morton code of their origin, so neighbouring rays in the
+/// order visit the same BVH nodes
+/// \author Josh Bailey
+
+#ifndef _RAYSORTER_H_
+#define _RAYSORTER_H_
+
+//File includes
+#include <cstdint>
+#include <vector>
+
+class RaySorter
+{
+public:
+	//Variables
+	std::vector<int> m_order;	//Indices of the rays in sorted order, filled by Sort()
+
+	//Functions
+	//Keys are 3 bits of octant above 27 bits of morton code over the bounds of the origins, least significant digit
+	//radix sorted, so rays already in order (camera rays of one tile) cost a few linear passes
+	void Sort(const float *_originX, const float *_originY, const float *_originZ, const float *_directionX, const float *_directionY, const float *_directionZ, int _count);
+
+private:
+	//Variables
+	std::vector<uint32_t> m_keys;
+	std::vector<uint32_t> m_sortedKeys;
+	std::vector<int> m_sortedOrder;
+};
+
+#endif // _RAYSORTER_H_
\ No newline at end of file
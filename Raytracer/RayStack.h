@@ -0,0 +1,69 @@
+/// \file RayStack.h
+/// \brief fixed size stack of the reflected and refracted rays still to be traced, so secondary rays never recurse
+/// \author Josh Bailey
+
+#ifndef _RAYSTACK_H_
+#define _RAYSTACK_H_
+
+//File includes
+#include <glm.hpp>
+
+#include "Random.h"
+
+static const int maxRayDepth = 16;	//Most bounces --depth allows, sets the size of every RayStack
+
+//A ray waiting to be traced, with the share of the pixel's colour whatever it hits contributes
+struct PendingRay
+{
+	glm::vec3 m_origin;
+	glm::vec3 m_direction;
+	glm::vec3 m_weight;
+	int m_depth;		//Bounces taken to get here, the camera ray is 0
+	PCG32 m_random;		//The ray's own roulette stream, so the order rays are traced in doesn't change the draws
+
+	//Functions
+	PendingRay() : m_random(0, 0)
+	{
+	}
+};
+
+class RayStack
+{
+public:
+	//Each ray pushes at most two one bounce deeper and one is popped straight away, so no more than one ray per depth
+	//waits below the newest pair
+	static const int capacity = maxRayDepth + 1;
+
+	//Functions
+	RayStack()
+	{
+		m_size = 0;
+	}
+
+	void Push(const PendingRay &_ray)
+	{
+		m_rays[m_size++] = _ray;
+	}
+
+	PendingRay Pop()
+	{
+		return m_rays[--m_size];
+	}
+
+	bool Empty() const
+	{
+		return m_size == 0;
+	}
+
+	void Clear()
+	{
+		m_size = 0;
+	}
+
+private:
+	//Variables
+	PendingRay m_rays[capacity];
+	int m_size;
+};
+
+#endif // _RAYSTACK_H_
\ No newline at end of file
@@ -0,0 +1,351 @@
+/// @file RenderSettings.cpp
+/// @brief Non-interactive command line parsing, so renders can run in batch jobs without anyone at the keyboard
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "RayStack.h"
+#include "RenderSettings.h"
+#include "TaskScheduler.h"
+
+RenderSettings::RenderSettings()
+{
+	//Defaults match the original fixed settings
+	m_imageWidth = 800;
+	m_imageHeight = 800;
+	m_samplesPerPixel = 1;
+	m_adaptiveThreshold = 0.0f;
+	m_minSamplesPerPixel = 8;
+	m_numberOfThreads = TaskScheduler::DefaultNumberOfWorkers();
+	m_tileSize = 16;
+	m_packetTracing = true;
+	m_compactBvh = false;
+	m_wavefront = false;
+	m_sortRays = false;
+	m_shadows = true;
+	m_integrator = integratorWhitted;
+	m_maxDepth = -1;
+	m_rouletteThreshold = 0.05f;
+	m_progressive = false;
+	m_snapshotInterval = 0.0f;
+	m_timeLimit = 0.0f;
+	m_checkpointInterval = 0.0f;
+	m_resume = false;
+	m_coordinatorPort = 0;
+	m_scene = "default";
+	m_output = "./output.ppm";
+	m_sampleMap = "";
+	m_worker = "";
+	m_benchmark = "";
+	m_writeGeometry = "";
+	m_selfTest = false;
+}
+
+//Reads the value following an option as a whole number no smaller than _minimum
+static bool ParsePositive(int _argc, char *_argv[], int *_index, int _minimum, int *_value)
+{
+	const char *option = _argv[*_index];
+	if (*_index + 1 >= _argc)
+	{
+		std::cout << "Missing value for " << option << std::endl;
+		return false;
+	}
+
+	++*_index;
+	char *end = nullptr;
+	long value = std::strtol(_argv[*_index], &end, 10);
+	if (end == _argv[*_index] || *end != '\0' || value < _minimum || value > 1000000)
+	{
+		std::cout << "Invalid value for " << option << ": " << _argv[*_index] << std::endl;
+		return false;
+	}
+
+	*_value = (int)value;
+	return true;
+}
+
+//Reads the value following an option as a number no smaller than zero
+static bool ParseNonNegative(int _argc, char *_argv[], int *_index, float *_value)
+{
+	const char *option = _argv[*_index];
+	if (*_index + 1 >= _argc)
+	{
+		std::cout << "Missing value for " << option << std::endl;
+		return false;
+	}
+
+	++*_index;
+	char *end = nullptr;
+	float value = std::strtof(_argv[*_index], &end);
+	if (end == _argv[*_index] || *end != '\0' || !(value >= 0.0f))
+	{
+		std::cout << "Invalid value for " << option << ": " << _argv[*_index] << std::endl;
+		return false;
+	}
+
+	*_value = value;
+	return true;
+}
+
+//Reads the value following an option as text
+static bool ParseString(int _argc, char *_argv[], int *_index, std::string *_value)
+{
+	if (*_index + 1 >= _argc)
+	{
+		std::cout << "Missing value for " << _argv[*_index] << std::endl;
+		return false;
+	}
+
+	++*_index;
+	*_value = _argv[*_index];
+	return true;
+}
+
+bool RenderSettings::ParseCommandLine(int _argc, char *_argv[])
+{
+	for (int i = 1; i < _argc; ++i)
+	{
+		const char *option = _argv[i];
+		bool valid = true;
+
+		if (std::strcmp(option, "--width") == 0)
+		{
+			valid = ParsePositive(_argc, _argv, &i, 1, &m_imageWidth);
+		}
+		else if (std::strcmp(option, "--height") == 0)
+		{
+			valid = ParsePositive(_argc, _argv, &i, 1, &m_imageHeight);
+		}
+		else if (std::strcmp(option, "--spp") == 0)
+		{
+			valid = ParsePositive(_argc, _argv, &i, 1, &m_samplesPerPixel);
+		}
+		else if (std::strcmp(option, "--adaptive") == 0)
+		{
+			valid = ParseNonNegative(_argc, _argv, &i, &m_adaptiveThreshold);
+		}
+		else if (std::strcmp(option, "--min-spp") == 0)
+		{
+			valid = ParsePositive(_argc, _argv, &i, 2, &m_minSamplesPerPixel);
+		}
+		else if (std::strcmp(option, "--sample-map") == 0)
+		{
+			valid = ParseString(_argc, _argv, &i, &m_sampleMap);
+		}
+		else if (std::strcmp(option, "--threads") == 0)
+		{
+			valid = ParsePositive(_argc, _argv, &i, 1, &m_numberOfThreads);
+		}
+		else if (std::strcmp(option, "--tile") == 0)
+		{
+			valid = ParsePositive(_argc, _argv, &i, 1, &m_tileSize);
+		}
+		else if (std::strcmp(option, "--no-packets") == 0)
+		{
+			m_packetTracing = false;
+		}
+		else if (std::strcmp(option, "--compact-bvh") == 0)
+		{
+			//Packets walk the binary tree, which isn't kept
+			m_compactBvh = true;
+			m_packetTracing = false;
+		}
+		else if (std::strcmp(option, "--wavefront") == 0)
+		{
+			m_wavefront = true;
+		}
+		else if (std::strcmp(option, "--sort-rays") == 0)
+		{
+			//Only the wavefront has batches of rays to sort
+			m_sortRays = true;
+			m_wavefront = true;
+		}
+		else if (std::strcmp(option, "--no-shadows") == 0)
+		{
+			m_shadows = false;
+		}
+		else if (std::strcmp(option, "--integrator") == 0)
+		{
+			std::string name;
+			valid = ParseString(_argc, _argv, &i, &name);
+			if (valid && name == IntegratorName(integratorWhitted))
+			{
+				m_integrator = integratorWhitted;
+			}
+			else if (valid && name == IntegratorName(integratorPath))
+			{
+				m_integrator = integratorPath;
+			}
+			else if (valid)
+			{
+				std::cout << "Invalid value for --integrator: " << name << std::endl;
+				valid = false;
+			}
+		}
+		else if (std::strcmp(option, "--depth") == 0)
+		{
+			//Bounded so every ray stack has a fixed size
+			valid = ParsePositive(_argc, _argv, &i, 0, &m_maxDepth);
+			if (valid && m_maxDepth > maxRayDepth)
+			{
+				std::cout << "Invalid value for --depth: at most " << maxRayDepth << std::endl;
+				valid = false;
+			}
+		}
+		else if (std::strcmp(option, "--roulette") == 0)
+		{
+			valid = ParseNonNegative(_argc, _argv, &i, &m_rouletteThreshold);
+		}
+		else if (std::strcmp(option, "--progressive") == 0)
+		{
+			m_progressive = true;
+		}
+		else if (std::strcmp(option, "--snapshot") == 0)
+		{
+			//Only a progressive render has anything worth writing before it finishes
+			valid = ParseNonNegative(_argc, _argv, &i, &m_snapshotInterval);
+			m_progressive = true;
+		}
+		else if (std::strcmp(option, "--time-limit") == 0)
+		{
+			valid = ParseNonNegative(_argc, _argv, &i, &m_timeLimit);
+		}
+		else if (std::strcmp(option, "--checkpoint") == 0)
+		{
+			valid = ParseNonNegative(_argc, _argv, &i, &m_checkpointInterval);
+		}
+		else if (std::strcmp(option, "--resume") == 0)
+		{
+			m_resume = true;
+		}
+		else if (std::strcmp(option, "--coordinator") == 0)
+		{
+			valid = ParsePositive(_argc, _argv, &i, 1, &m_coordinatorPort);
+		}
+		else if (std::strcmp(option, "--worker") == 0)
+		{
+			valid = ParseString(_argc, _argv, &i, &m_worker);
+		}
+		else if (std::strcmp(option, "--scene") == 0)
+		{
+			valid = ParseString(_argc, _argv, &i, &m_scene);
+		}
+		else if (std::strcmp(option, "--output") == 0)
+		{
+			valid = ParseString(_argc, _argv, &i, &m_output);
+		}
+		else if (std::strcmp(option, "--write-geometry") == 0)
+		{
+			valid = ParseString(_argc, _argv, &i, &m_writeGeometry);
+		}
+		else if (std::strcmp(option, "--benchmark") == 0)
+		{
+			valid = ParseString(_argc, _argv, &i, &m_benchmark);
+		}
+		else if (std::strcmp(option, "--self-test") == 0)
+		{
+			m_selfTest = true;
+		}
+		else if (std::strcmp(option, "--help") == 0 || std::strcmp(option, "-h") == 0)
+		{
+			PrintUsage(_argv[0]);
+			return false;
+		}
+		else
+		{
+			std::cout << "Unknown option: " << option << std::endl;
+			PrintUsage(_argv[0]);
+			return false;
+		}
+
+		if (!valid)
+		{
+			return false;
+		}
+	}
+
+	//Pixels are numbered in an int from the top left, through the tiles, integrators and checkpoints
+	if ((long long)m_imageWidth * m_imageHeight > INT_MAX)
+	{
+		std::cout << "Image of " << m_imageWidth << "x" << m_imageHeight << " is too large, at most " << INT_MAX << " pixels" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool RenderSettings::ParseOptions(const std::vector<std::string> &_options)
+{
+	//Laid out as a command line, the parser never writes through argv
+	std::vector<char *> argv;
+	argv.push_back(const_cast<char *>("settings"));
+	for (const std::string &option : _options)
+	{
+		argv.push_back(const_cast<char *>(option.c_str()));
+	}
+	argv.push_back(nullptr);
+	return ParseCommandLine((int)argv.size() - 1, argv.data());
+}
+
+std::string RenderSettings::CheckpointPath() const
+{
+	return m_output + ".checkpoint";
+}
+
+int RenderSettings::MaxDepth() const
+{
+	if (m_maxDepth >= 0)
+	{
+		return m_maxDepth;
+	}
+	//Previews stay as the original renderer shaded, a path needs a few bounces before the light it gathers is worth little
+	return m_integrator == integratorPath ? 8 : 0;
+}
+
+bool RenderSettings::Shadows() const
+{
+	//Skipping them is a preview shortcut, a path traced light sample that ignored occluders would bias the image
+	return m_shadows || m_integrator == integratorPath;
+}
+
+const char *RenderSettings::IntegratorName(IntegratorType _integrator)
+{
+	return _integrator == integratorPath ? "path" : "whitted";
+}
+
+void RenderSettings::PrintUsage(const char *_program)
+{
+	RenderSettings defaults;
+	std::cout << "Usage: " << _program << " [options]\n\n"
+		<< " --width N       Image width in pixels (" << defaults.m_imageWidth << ")\n"
+		<< " --height N      Image height in pixels (" << defaults.m_imageHeight << ")\n"
+		<< " --spp N         Samples per pixel, jittered within a grid over the pixel (" << defaults.m_samplesPerPixel << ")\n"
+		<< " --adaptive E    Stop sampling a pixel once the standard error of its colour is below E, --spp is the most it gets\n"
+		<< " --min-spp N     Samples every pixel gets before --adaptive can stop it (" << defaults.m_minSamplesPerPixel << ")\n"
+		<< " --sample-map FILE  Write a greyscale .ppm of the samples each pixel took\n"
+		<< " --threads N     Worker threads (" << defaults.m_numberOfThreads << ", one per hardware thread)\n"
+		<< " --tile N        Tile size in pixels (" << defaults.m_tileSize << ")\n"
+		<< " --no-packets    Trace primary rays one at a time\n"
+		<< " --compact-bvh   Keep only BVH nodes with their bounds in 8 bits, for very large scenes, primary rays go one at a time\n"
+		<< " --wavefront     Trace each round of a tile's samples a stage at a time (extend, shade, connect) over queues of rays\n"
+		<< " --sort-rays     Wavefront, tracing bounces and shadow rays in order of direction octant and origin for coherence\n"
+		<< " --no-shadows    whitted lights every hit without testing for occluders (path always tests)\n"
+		<< " --integrator NAME  whitted for phong shading with mirror and glass, or path to path trace (" << IntegratorName(defaults.m_integrator) << ")\n"
+		<< " --depth N       Bounces after the camera ray, up to " << maxRayDepth << " (whitted 0 for local shading only, path 8)\n"
+		<< " --roulette T    Rays carrying less than T of a pixel's colour are ended at random (" << defaults.m_rouletteThreshold << ", 0 for never)\n"
+		<< " --progressive   Render in passes of doubling spp, each pass refining the whole image\n"
+		<< " --snapshot S    Progressive, and write the image so far to --output at most every S seconds\n"
+		<< " --time-limit S  Stop after S seconds and output the samples taken so far\n"
+		<< " --checkpoint S  Save the render so far to FILE.checkpoint beside --output every S seconds\n"
+		<< " --resume        Carry on from FILE.checkpoint, with the same settings it was started with\n"
+		<< " --coordinator PORT  Render across worker processes that connect on PORT instead of here\n"
+		<< " --worker HOST:PORT  Render tiles for the coordinator at HOST:PORT, taking the scene and sampling from it\n"
+		<< " --scene NAME    default, particles:N for N random spheres, obj:FILE, geo:FILE, or a FILE.scene scene file (" << defaults.m_scene << ")\n"
+		<< " --output FILE   Output .ppm (" << defaults.m_output << ")\n"
+		<< " --write-geometry FILE  Write the scene's meshes to a geometry file for geo:FILE to map, instead of rendering\n"
+		<< " --benchmark FILE  Time the built-in scenes at several resolutions and thread counts (up to --threads),\n"
+		<< "                   write CSV, or JSON if FILE ends in .json\n"
+		<< " --self-test     Check that the faster ways of tracing give the same trees, hits and images as the plain ones,\n"
+		<< "                 and that damaged input files are refused\n";
+}
\ No newline at end of file
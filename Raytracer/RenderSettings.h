@@ -0,0 +1,64 @@
+/// \file RenderSettings.h
+/// \brief everything a render needs to know that isn't in the scene, filled in from the command line
+/// \author Josh Bailey
+
+#ifndef _RENDERSETTINGS_H_
+#define _RENDERSETTINGS_H_
+
+//File includes
+#include <string>
+#include <vector>
+
+//Ways of turning a camera ray into a colour, see Integrator.h
+enum IntegratorType
+{
+	integratorWhitted,	//Phong shading plus mirror and glass, the fast preview
+	integratorPath		//Path tracing, the final quality render
+};
+
+class RenderSettings
+{
+public:
+	//Variables
+	int m_imageWidth;
+	int m_imageHeight;
+	int m_samplesPerPixel;		//Most samples any pixel gets
+	float m_adaptiveThreshold;	//Stop sampling a pixel once the standard error of its mean is below this, 0 samples every pixel fully
+	int m_minSamplesPerPixel;	//Samples every pixel gets before adaptive sampling can stop it
+	int m_numberOfThreads;
+	int m_tileSize;				//Width and height in pixels of the square tiles handed to each worker
+	bool m_packetTracing;		//Trace primary rays in 4x4 packets rather than one at a time
+	bool m_compactBvh;			//Trace single rays through quantised 64 byte BVH nodes, see CompressedBVH.h
+	bool m_wavefront;			//Trace each round of a tile's samples a stage at a time over queues of rays, see Wavefront.h
+	bool m_sortRays;			//Wavefront stages trace bounces and shadow rays grouped by direction and origin, see RaySorter.h
+	bool m_shadows;				//Cast a shadow ray towards the light from every hit, see Shadows()
+	IntegratorType m_integrator;
+	int m_maxDepth;				//Bounces after the camera ray, -1 for the integrator's own default, see MaxDepth()
+	float m_rouletteThreshold;	//Rays carrying less than this share of the pixel's colour survive at random, weighted up to
+								//stay unbiased, 0 traces every ray to the full depth
+	bool m_progressive;			//Render in passes of doubling spp so the image is usable long before it is finished
+	float m_snapshotInterval;	//Seconds between snapshots of a progressive render written to m_output, 0 writes none
+	float m_timeLimit;			//Seconds after which the render stops and keeps what it has, 0 for no limit
+	float m_checkpointInterval;	//Seconds between checkpoints written to CheckpointPath(), 0 writes none
+	bool m_resume;				//Carry on from the checkpoint at CheckpointPath() rather than starting again
+	int m_coordinatorPort;		//When set, hand tiles out to workers connecting on this port instead of rendering them here
+	std::string m_worker;		//When set, HOST:PORT of a coordinator to render tiles for
+	std::string m_scene;		//Built-in scene name or .scene file
+	std::string m_output;		//Path of the .ppm written at the end
+	std::string m_sampleMap;	//When set, a greyscale .ppm of how many samples each pixel took is written here
+	std::string m_benchmark;	//When set, run the benchmark suite and write its report here instead of rendering
+	std::string m_writeGeometry;	//When set, write the scene's meshes here as a geometry file instead of rendering
+	bool m_selfTest;			//Run the checks in SelfTest.h instead of rendering
+
+	//Functions
+	RenderSettings();
+	bool ParseCommandLine(int _argc, char *_argv[]);	//False (with a message printed) if the arguments are invalid or --help was asked for
+	bool ParseOptions(const std::vector<std::string> &_options);	//Same options as the command line, from somewhere else such as a scene file
+	std::string CheckpointPath() const;		//Beside the output, so separate jobs don't share one
+	int MaxDepth() const;					//m_maxDepth, or the integrator's default when it wasn't given
+	bool Shadows() const;					//m_shadows for whitted, the path tracer always tests its light samples for occluders
+	static const char *IntegratorName(IntegratorType _integrator);
+	static void PrintUsage(const char *_program);
+};
+
+#endif // _RENDERSETTINGS_H_
\ No newline at end of file
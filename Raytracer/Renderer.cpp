@@ -0,0 +1,680 @@
+/// @file Renderer.cpp
+/// @brief Casts rays for every pixel of the image, shared by the normal render and the benchmark
+
+#include <algorithm>	//Use of std::min when outputting image
+#include <cmath>
+#include <cstdio>		//std::remove for finished checkpoints, printf for build statistics
+#include <fstream>		//Output image
+#include <iostream>
+#include <numeric>		//std::accumulate for the average sample count
+
+#include "FileUtilities.h"
+#include "Random.h"
+#include "RayPacket.h"
+#include "Renderer.h"
+#include "Scenes.h"
+#include "Wavefront.h"
+
+//Greatest common divisor, std::gcd needs C++17
+static int Gcd(int _a, int _b)
+{
+	while (_b != 0)
+	{
+		int remainder = _a % _b;
+		_a = _b;
+		_b = remainder;
+	}
+	return _a;
+}
+
+Renderer::Renderer()
+{
+	m_raysTraced = 0;
+	m_strataColumns = 1;
+	m_strataRows = 1;
+	m_strataStride = 1;
+	m_deadline = std::chrono::steady_clock::time_point::max();
+	m_finished = true;
+	m_endSample = 0;
+	m_resuming = false;
+	m_stopCheckpoints = false;
+}
+
+bool Renderer::LoadScene(const std::string &_name, TaskScheduler &_scheduler)
+{
+	if (!DescribeScene(_name))
+	{
+		return false;
+	}
+	return BuildAccelerationStructure(_scheduler);
+}
+
+bool Renderer::DescribeScene(const std::string &_name)
+{
+	m_description.Clear();
+	return InstantiateScene(_name, m_description);		//Creating shapes
+}
+
+bool Renderer::BuildAccelerationStructure(TaskScheduler &_scheduler)
+{
+	//Flattened once, nothing below here touches m_description.m_listOfShapes
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (!m_scene.Build(m_description.m_listOfShapes, m_description.m_materials, m_settings.m_compactBvh, _scheduler))
+	{
+		return false;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	//Part of every load, so it is reported like a render
+	printf(" Built BVH over %d primitives in %.3fs with %d thread(s): %d nodes, SAH cost %.2f\n", m_scene.NumberOfPrimitives(), seconds,
+		_scheduler.NumberOfWorkers(), m_scene.m_bvhNodes, m_scene.m_bvhCost);
+	return true;
+}
+
+bool Renderer::Resume(const std::string &_path)
+{
+	if (!m_resumeFrom.Read(_path))
+	{
+		return false;
+	}
+	if (!m_resumeFrom.Matches(m_settings))
+	{
+		std::cout << "Checkpoint " << _path << " was started with a different scene, size, spp, tile size or sampling options" << std::endl;
+		return false;
+	}
+	m_resuming = true;
+	return true;
+}
+
+void Renderer::BeginRender()
+{
+	m_deadline = std::chrono::steady_clock::time_point::max();
+	if (m_settings.m_timeLimit > 0.0f)
+	{
+		m_deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(m_settings.m_timeLimit));
+	}
+
+	//Contiguous image to represent view plane, black until a tile has sampled it
+	m_image.Resize(m_settings.m_imageWidth, m_settings.m_imageHeight);
+	m_image.Clear(glm::vec3(0, 0, 0));
+	m_estimates.assign((size_t)m_settings.m_imageWidth * m_settings.m_imageHeight, PixelEstimate());
+	m_raysTraced = 0;
+
+	//Pixel split into a grid of strata, one sample each
+	int samplesPerPixel = m_settings.m_samplesPerPixel;
+	m_strataColumns = (int)glm::ceil(glm::sqrt((float)samplesPerPixel));
+	m_strataRows = (samplesPerPixel + m_strataColumns - 1) / m_strataColumns;
+
+	//Consecutive samples step through the strata by roughly the golden ratio of the grid, so a pixel that adaptive
+	//sampling stops early has still spread its samples over the whole pixel rather than filling its top rows
+	int strata = m_strataColumns * m_strataRows;
+	m_strataStride = std::max(1, (int)glm::round(strata * 0.618034f));
+	while (Gcd(m_strataStride, strata) != 1)
+	{
+		++m_strataStride;
+	}
+
+	m_integrator = CreateIntegrator(m_scene, m_description, m_settings);
+}
+
+void Renderer::Render(TaskScheduler &_scheduler)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	BeginRender();
+
+	int samplesPerPixel = m_settings.m_samplesPerPixel;
+	int tileSize = m_settings.m_tileSize;
+	int tilesAcross = (m_image.Width() + tileSize - 1) / tileSize;
+	int tilesDown = (m_image.Height() + tileSize - 1) / tileSize;
+	m_tilesDone.assign((size_t)tilesAcross * tilesDown, 0);
+
+	//One pass takes every sample, progressive passes double the samples each pixel has, up to a limit so that
+	//snapshots keep coming at high spp
+	const int mostSamplesPerPass = 32;
+	int endSample = m_settings.m_progressive ? 1 : samplesPerPixel;
+	std::chrono::steady_clock::time_point lastSnapshot = start;
+
+	//Pick up the pass that was in progress, the jitter only depends on the pixel and sample number so the samples still
+	//to come are the ones the first run would have taken
+	if (m_resuming)
+	{
+		m_estimates.swap(m_resumeFrom.m_estimates);
+		m_tilesDone.swap(m_resumeFrom.m_tilesDone);
+		endSample = m_resumeFrom.m_endSample;
+		for (int y = 0; y < m_image.Height(); ++y)
+		{
+			for (int x = 0; x < m_image.Width(); ++x)
+			{
+				m_image.Pixel(x, y) = m_estimates[(size_t)y * m_image.Width() + x].m_mean;
+			}
+		}
+		m_resuming = false;
+	}
+	m_endSample = endSample;
+
+	std::thread checkpointer;
+	if (m_settings.m_checkpointInterval > 0.0f)
+	{
+		m_stopCheckpoints = false;
+		checkpointer = std::thread([this] { CheckpointLoop(); });
+	}
+
+	while (true)
+	{
+		//Small tiles so a worker that finishes early can steal from one stuck on an expensive region
+		for (int tileY = 0; tileY < tilesDown; ++tileY)
+		{
+			for (int tileX = 0; tileX < tilesAcross; ++tileX)
+			{
+				int tileIndex = tileY * tilesAcross + tileX;
+				if (m_tilesDone[tileIndex])
+				{
+					continue;
+				}
+
+				//Each worker only ever writes inside its own tile
+				int startX = tileX * tileSize;
+				int startY = tileY * tileSize;
+				FramebufferTile tile = m_image.Tile(startX, startY, std::min(tileSize, m_image.Width() - startX), std::min(tileSize, m_image.Height() - startY));
+				_scheduler.Submit([=] { RenderTile(tile, tileIndex, endSample); });
+			}
+		}
+
+		_scheduler.Wait();
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (endSample >= samplesPerPixel || now >= m_deadline)
+		{
+			break;
+		}
+
+		//Every pixel has the same samples between passes, so a snapshot is a consistent lower spp image
+		if (m_settings.m_snapshotInterval > 0.0f && std::chrono::duration<float>(now - lastSnapshot).count() >= m_settings.m_snapshotInterval)
+		{
+			Snapshot();
+			lastSnapshot = now;
+		}
+		endSample = std::min(samplesPerPixel, endSample + std::min(endSample, mostSamplesPerPass));
+
+		std::lock_guard<std::mutex> lock(m_estimatesLock);
+		m_endSample = endSample;
+		std::fill(m_tilesDone.begin(), m_tilesDone.end(), 0);
+	}
+
+	if (m_snapshotWriter.joinable())
+	{
+		m_snapshotWriter.join();
+	}
+
+	if (checkpointer.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_checkpointLock);
+			m_stopCheckpoints = true;
+		}
+		m_checkpointWake.notify_all();
+		checkpointer.join();
+	}
+
+	//Cut off by the time limit if any pixel still wanted samples
+	m_finished = true;
+	for (size_t p = 0; p < m_estimates.size(); ++p)
+	{
+		if (!m_estimates[p].Converged())
+		{
+			m_finished = false;
+			break;
+		}
+	}
+
+	//A render stopped by the time limit can be resumed, a finished one has no use for its checkpoint
+	if (m_settings.m_checkpointInterval > 0.0f)
+	{
+		if (m_finished)
+		{
+			std::remove(m_settings.CheckpointPath().c_str());
+		}
+		else
+		{
+			SaveCheckpoint();
+		}
+	}
+}
+
+void Renderer::RenderRegion(TaskScheduler &_scheduler, int _startX, int _startY, int _width, int _height)
+{
+	//Split into the same tiles Render() would use when the region is aligned to them
+	int tileSize = m_settings.m_tileSize;
+	int endX = _startX + _width;
+	int endY = _startY + _height;
+	for (int startY = _startY; startY < endY; startY += tileSize)
+	{
+		for (int startX = _startX; startX < endX; startX += tileSize)
+		{
+			FramebufferTile tile = m_image.Tile(startX, startY, std::min(tileSize, endX - startX), std::min(tileSize, endY - startY));
+			_scheduler.Submit([=] { RenderTile(tile, -1, m_settings.m_samplesPerPixel); });
+		}
+	}
+
+	_scheduler.Wait();
+}
+
+const PixelEstimate &Renderer::Estimate(int _x, int _y) const
+{
+	return m_estimates[(size_t)_y * m_settings.m_imageWidth + _x];
+}
+
+void Renderer::StoreRegion(int _startX, int _startY, int _width, int _height, const PixelEstimate *_estimates, long long _raysTraced)
+{
+	for (int y = 0; y < _height; ++y)
+	{
+		for (int x = 0; x < _width; ++x)
+		{
+			const PixelEstimate &estimate = _estimates[y * _width + x];
+			m_estimates[(size_t)(_startY + y) * m_settings.m_imageWidth + _startX + x] = estimate;
+			m_image.Pixel(_startX + x, _startY + y) = estimate.m_mean;
+		}
+	}
+	m_raysTraced += _raysTraced;
+}
+
+long long Renderer::RaysTraced() const
+{
+	return m_raysTraced;
+}
+
+double Renderer::AverageSamplesPerPixel() const
+{
+	if (m_estimates.empty())
+	{
+		return 0.0;
+	}
+	double samples = std::accumulate(m_estimates.begin(), m_estimates.end(), 0.0, [](double _sum, const PixelEstimate &_estimate) { return _sum + _estimate.Samples(); });
+	return samples / m_estimates.size();
+}
+
+bool Renderer::Finished() const
+{
+	return m_finished;
+}
+
+glm::vec3 Renderer::ScreenInitialisation(int _i, int _j, float _offsetX, float _offsetY)
+{
+	int imageWidth = m_settings.m_imageWidth;
+	int imageHeight = m_settings.m_imageHeight;
+
+	//Normalize pixels positions to range [0, 1] using screen dimensions, offset (0.5 by default) so ray passes through pixel centre
+	float normalizePixelX = (_i + _offsetX) / imageWidth;
+	float normalizePixelY = (_j + _offsetY) / imageHeight;
+
+	float imageAspectRatio = (float)imageWidth / imageHeight;	//Calculate aspect ratio of image (if not square)
+
+	//Remap coordinates from range [0, 1] to [-1, 1], and reverse direction of Y axis
+	float remapPixelX = (2 * normalizePixelX - 1) * imageAspectRatio;	//Multiply by imageAspectRatio as width is larger than height
+	float remapPixelY = 1 - 2 * normalizePixelY;
+
+	//Lies on the image plane which is 1 unit in front of the camera, scaled by its field of view
+	return m_description.m_camera.PointOnImagePlane(remapPixelX, remapPixelY);
+}
+
+glm::vec2 Renderer::SampleOffset(int _i, int _j, int _sample)
+{
+	//A single sample stays on the pixel centre, so one sample per pixel renders the same image every time
+	if (m_settings.m_samplesPerPixel == 1)
+	{
+		return glm::vec2(0.5f, 0.5f);
+	}
+
+	//Sample n is jittered within its own stratum, visited in the order set up by Render()
+	int stratum = (int)(((long long)_sample * m_strataStride) % (m_strataColumns * m_strataRows));
+
+	//Stream per pixel, seeded by the stratum, so the pattern doesn't depend on tile size or which thread renders it
+	PCG32 random((uint64_t)stratum, (uint64_t)_j * m_settings.m_imageWidth + _i);
+	float jitterX = random.NextFloat();
+	float jitterY = random.NextFloat();
+	return glm::vec2(((stratum % m_strataColumns) + jitterX) / m_strataColumns, ((stratum / m_strataColumns) + jitterY) / m_strataRows);
+}
+
+//Output and save image as a .ppm, rows in the same order they are stored
+static bool WriteImage(const Framebuffer &_image, const std::string &_path)
+{
+	std::ofstream ofs(_path.c_str(), std::ios::out | std::ios::binary);
+	if (!ofs)
+	{
+		return false;
+	}
+	ofs << "P6\n" << _image.Width() << " " << _image.Height() << "\n255\n";
+	for (int y = 0; y < _image.Height(); y++)
+	{
+		for (int x = 0; x < _image.Width(); x++)
+		{
+			const glm::vec3 &pixel = _image.Pixel(x, y);
+			ofs << (unsigned char)(std::min((float)1, (float)pixel.x) * 255) <<
+				(unsigned char)(std::min((float)1, (float)pixel.y) * 255) <<
+				(unsigned char)(std::min((float)1, (float)pixel.z) * 255);
+		}
+	}
+	ofs.close();
+	return !ofs.fail();
+}
+
+bool Renderer::OutputToImage(const std::string &_path)
+{
+	return WriteImage(m_image, _path);
+}
+
+bool Renderer::OutputSampleMap(const std::string &_path)
+{
+	//Same format as the image, every channel the fraction of m_samplesPerPixel the pixel took
+	std::ofstream ofs(_path.c_str(), std::ios::out | std::ios::binary);
+	if (!ofs)
+	{
+		return false;
+	}
+	ofs << "P6\n" << m_image.Width() << " " << m_image.Height() << "\n255\n";
+	for (size_t p = 0; p < m_estimates.size(); p++)
+	{
+		unsigned char value = (unsigned char)(m_estimates[p].Samples() * 255 / m_settings.m_samplesPerPixel);
+		ofs << value << value << value;
+	}
+	ofs.close();
+	return !ofs.fail();
+}
+
+void Renderer::Snapshot()
+{
+	//The previous snapshot has had a whole pass to finish writing
+	if (m_snapshotWriter.joinable())
+	{
+		m_snapshotWriter.join();
+	}
+
+	//Only the copy happens between passes, the file is written while the next pass renders
+	m_snapshot.CopyFrom(m_image);
+	std::string path = m_settings.m_output;
+	m_snapshotWriter = std::thread([this, path]
+	{
+		std::string partial = path + ".part";
+		if (WriteImage(m_snapshot, partial))
+		{
+			ReplaceFile(partial, path);
+		}
+	});
+}
+
+void Renderer::SaveCheckpoint()
+{
+	//Tiles in the middle of the pass still have their estimates from before it, so the copy is consistent without
+	//stopping the workers, only a tile writing back at the same moment waits
+	Checkpoint checkpoint;
+	checkpoint.Describe(m_settings);
+	{
+		std::lock_guard<std::mutex> lock(m_estimatesLock);
+		checkpoint.m_endSample = m_endSample;
+		checkpoint.m_tilesDone = m_tilesDone;
+		checkpoint.m_estimates = m_estimates;
+	}
+
+	std::string path = m_settings.CheckpointPath();
+	std::string partial = path + ".part";
+	if (!checkpoint.Write(partial) || !ReplaceFile(partial, path))
+	{
+		std::cout << "Could not write checkpoint " << path << std::endl;
+	}
+}
+
+void Renderer::CheckpointLoop()
+{
+	std::chrono::duration<float> interval(m_settings.m_checkpointInterval);
+	std::unique_lock<std::mutex> lock(m_checkpointLock);
+	while (!m_checkpointWake.wait_for(lock, interval, [this] { return m_stopCheckpoints; }))
+	{
+		lock.unlock();
+		SaveCheckpoint();
+		lock.lock();
+	}
+}
+
+glm::vec3 Renderer::ShootRay(int _i, int _j, int _sample, long long *_secondaryRays)
+{
+	glm::vec2 offset = SampleOffset(_i, _j, _sample);
+	glm::vec3 pointCameraSpace = ScreenInitialisation(_i, _j, offset.x, offset.y);
+
+	glm::vec3 originOfRay = m_description.m_camera.Position();		//Origin of ray
+
+	glm::vec3 directionOfRay = glm::normalize(pointCameraSpace - originOfRay);	//Ray shoots from the camera through the image plane, normalize directionOfRay (returns direction with the magnitude of 1)
+
+	//Intersection phase, the closest hit is all that is kept
+	HitRecord hit;
+	m_scene.Intersection(&hit, originOfRay, directionOfRay);
+
+	//Shading phase, once per pixel, else the pixel colour is white (background)
+	return m_integrator->Radiance(hit, originOfRay, directionOfRay, _j * m_settings.m_imageWidth + _i, _sample, _secondaryRays);
+}
+
+void Renderer::ShootPacket(int _startX, int _startY, int _endX, int _endY, FramebufferTile &_samples, const char *_active, const PixelEstimate *_estimates, long long *_secondaryRays)
+{
+	glm::vec3 originOfRay = m_description.m_camera.Position();		//Origin shared by every ray in the packet
+
+	//Each ray jittered within its own pixel, the packet stays coherent as they are still neighbours
+	RayPacket packet;
+	packet.Reset(originOfRay);
+	for (int j = _startY; j < _endY; ++j)
+	{
+		for (int i = _startX; i < _endX; ++i)
+		{
+			//Pixels that have stopped sampling leave a gap in the packet
+			int p = (j - _samples.m_startY) * _samples.m_width + (i - _samples.m_startX);
+			if (!_active[p])
+			{
+				continue;
+			}
+			glm::vec2 offset = SampleOffset(i, j, _estimates[p].Samples());
+			glm::vec3 pointCameraSpace = ScreenInitialisation(i, j, offset.x, offset.y);
+			packet.AddRay(i, j, glm::normalize(pointCameraSpace - originOfRay));
+		}
+	}
+
+	if (packet.m_count == 0)
+	{
+		return;
+	}
+
+	packet.Intersection(m_scene);
+
+	//Shade each pixel once from its own closest hit, storing this sample for the tile to add in, whatever the
+	//integrator traces beyond it goes its own way so is traced one ray at a time
+	for (int r = 0; r < packet.m_count; ++r)
+	{
+		int i = packet.m_pixelX[r];
+		int j = packet.m_pixelY[r];
+		int sample = _estimates[(j - _samples.m_startY) * _samples.m_width + (i - _samples.m_startX)].Samples();
+		_samples.Pixel(i, j) = m_integrator->Radiance(packet.Hit(r), originOfRay, packet.Direction(r), j * m_settings.m_imageWidth + i, sample, _secondaryRays);
+	}
+}
+
+void Renderer::ShootWavefront(FramebufferTile &_samples, const char *_active, const PixelEstimate *_estimates, long long *_secondaryRays)
+{
+	glm::vec3 originOfRay = m_description.m_camera.Position();
+
+	//Generate, a camera ray for each pixel still sampling, its colour the pixel's sample
+	static thread_local Wavefront wavefront;
+	wavefront.m_rays.Clear();
+	for (int j = _samples.m_startY; j < _samples.m_startY + _samples.m_height; ++j)
+	{
+		for (int i = _samples.m_startX; i < _samples.m_startX + _samples.m_width; ++i)
+		{
+			int p = (j - _samples.m_startY) * _samples.m_width + (i - _samples.m_startX);
+			if (!_active[p])
+			{
+				continue;
+			}
+			glm::vec2 offset = SampleOffset(i, j, _estimates[p].Samples());
+			glm::vec3 pointCameraSpace = ScreenInitialisation(i, j, offset.x, offset.y);
+			glm::vec3 directionOfRay = glm::normalize(pointCameraSpace - originOfRay);
+			wavefront.m_rays.Push(m_integrator->CameraRay(originOfRay, directionOfRay, j * m_settings.m_imageWidth + i, _estimates[p].Samples(), p));
+			_samples.Pixel(i, j) = glm::vec3(0, 0, 0);
+		}
+	}
+
+	//The samples are laid out a row of the tile after another, as the colours are indexed
+	wavefront.Trace(m_scene, *m_integrator, m_settings.Shadows(), m_settings.m_sortRays, _samples.m_pixels, _secondaryRays);
+}
+
+void Renderer::RenderTile(FramebufferTile _tile, int _tileIndex, int _endSample)
+{
+	int endX = _tile.m_startX + _tile.m_width;
+	int endY = _tile.m_startY + _tile.m_height;
+	int imageWidth = m_settings.m_imageWidth;
+	int samplesPerPixel = m_settings.m_samplesPerPixel;
+	int minSamplesPerPixel = std::min(m_settings.m_minSamplesPerPixel, samplesPerPixel);
+	float threshold = m_settings.m_adaptiveThreshold;
+	int tilePixels = _tile.m_width * _tile.m_height;
+	long long primaryRays = 0;
+	long long secondaryRays = 0;	//Shadow, reflected and refracted
+
+	//The tile's estimates are copied into buffers private to this thread and written back once at the end, rows of
+	//neighbouring tiles share cache lines in the image and updating them every sample would bounce them between cores
+	static thread_local std::vector<PixelEstimate> estimates;
+	static thread_local std::vector<glm::vec3> samplePixels;
+	static thread_local std::vector<char> active;
+	estimates.resize(tilePixels);
+	samplePixels.resize(tilePixels);
+	active.resize(tilePixels);
+	FramebufferTile samples = _tile;
+	samples.m_pixels = samplePixels.data();
+	samples.m_stride = _tile.m_width;
+
+	int activePixels = 0;
+	for (int j = _tile.m_startY; j < endY; ++j)
+	{
+		for (int i = _tile.m_startX; i < endX; ++i)
+		{
+			int p = (j - _tile.m_startY) * _tile.m_width + (i - _tile.m_startX);
+			estimates[p] = m_estimates[(size_t)j * imageWidth + i];
+			active[p] = !estimates[p].Converged() && estimates[p].Samples() < _endSample;
+			activePixels += active[p];
+		}
+	}
+
+	//Every pixel still sampling takes the same sample number in a pass, so packets stay full until pixels converge
+	while (activePixels > 0 && std::chrono::steady_clock::now() < m_deadline)
+	{
+		primaryRays += activePixels;
+
+		if (m_settings.m_wavefront)
+		{
+			ShootWavefront(samples, active.data(), estimates.data(), &secondaryRays);
+		}
+		else
+#ifdef RAYPACKET_SIMD
+		if (m_settings.m_packetTracing)
+		{
+			//Neighbouring pixels as 4x4 packets, partial packets at the tile edges
+			for (int packetY = _tile.m_startY; packetY < endY; packetY += RayPacket::packetWidth)
+			{
+				for (int packetX = _tile.m_startX; packetX < endX; packetX += RayPacket::packetWidth)
+				{
+					ShootPacket(packetX, packetY, std::min(packetX + RayPacket::packetWidth, endX), std::min(packetY + RayPacket::packetWidth, endY), samples, active.data(), estimates.data(), &secondaryRays);
+				}
+			}
+		}
+		else
+#endif
+		{
+			//Loop through pixels in Y axis, rows are contiguous in the buffer
+			for (int j = _tile.m_startY; j < endY; ++j)
+			{
+				//Loop through pixels in X axis
+				for (int i = _tile.m_startX; i < endX; ++i)
+				{
+					int p = (j - _tile.m_startY) * _tile.m_width + (i - _tile.m_startX);
+					if (active[p])
+					{
+						samples.Pixel(i, j) = ShootRay(i, j, estimates[p].Samples(), &secondaryRays);
+					}
+				}
+			}
+		}
+
+		//Add the sample into each pixel's running estimate
+		for (int p = 0; p < tilePixels; ++p)
+		{
+			if (!active[p])
+			{
+				continue;
+			}
+
+			PixelEstimate &estimate = estimates[p];
+			estimate.Add(samplePixels[p]);
+
+			//Squared standard error of the mean of the noisiest channel, only trusted after the minimum number of samples
+			int count = estimate.Samples();
+			if (count >= minSamplesPerPixel)
+			{
+				glm::vec3 variance = estimate.m_squaredDifferences / ((float)count * (float)(count - 1));	//In float, count * (count - 1) overflows an int past 46341 samples
+				estimate.m_squaredError = glm::max(variance.x, glm::max(variance.y, variance.z));
+			}
+		}
+
+		//Stop the pixels that are good enough, a pixel whose samples all happened to land on one side of an edge looks
+		//converged on its own, so its neighbours within the tile must agree before it stops
+		for (int y = 0; y < _tile.m_height; ++y)
+		{
+			for (int x = 0; x < _tile.m_width; ++x)
+			{
+				int p = y * _tile.m_width + x;
+				if (!active[p])
+				{
+					continue;
+				}
+
+				PixelEstimate &estimate = estimates[p];
+				bool done = estimate.Samples() >= samplesPerPixel;
+				if (!done && threshold > 0.0f)
+				{
+					//Left, right, above and below, clamped to the tile
+					int neighbours[4] = { p - (x > 0), p + (x + 1 < _tile.m_width), p - (y > 0) * _tile.m_width, p + (y + 1 < _tile.m_height) * _tile.m_width };
+					float squaredError = estimate.m_squaredError;
+					for (int n = 0; n < 4; ++n)
+					{
+						squaredError = glm::max(squaredError, estimates[neighbours[n]].m_squaredError);
+					}
+					done = squaredError <= threshold * threshold;
+				}
+				if (done)
+				{
+					estimate.Converge();
+				}
+
+				//Converged, or has all the samples this pass asked for
+				if (done || estimate.Samples() >= _endSample)
+				{
+					active[p] = 0;
+					--activePixels;
+				}
+			}
+		}
+	}
+
+	//Estimates back, and their means are the only writes this tile makes to the shared image
+	std::lock_guard<std::mutex> lock(m_estimatesLock);
+	for (int j = _tile.m_startY; j < endY; ++j)
+	{
+		for (int i = _tile.m_startX; i < endX; ++i)
+		{
+			int p = (j - _tile.m_startY) * _tile.m_width + (i - _tile.m_startX);
+			m_estimates[(size_t)j * imageWidth + i] = estimates[p];
+			_tile.Pixel(i, j) = estimates[p].m_mean;
+		}
+	}
+
+	//Cut off by the time limit, the tile is rendered again on resume
+	if (_tileIndex >= 0)
+	{
+		m_tilesDone[_tileIndex] = activePixels == 0;
+	}
+
+	//Primary rays actually traced plus the rays they led to, counted once per tile to keep the atomic off the hot path
+	m_raysTraced += primaryRays + secondaryRays;
+}
\ No newline at end of file
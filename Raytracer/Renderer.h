@@ -0,0 +1,88 @@
+/// \file Renderer.h
+/// \brief owns the scene, acceleration structures and image, and renders tiles of it on a TaskScheduler
+/// \author Josh Bailey
+
+#ifndef _RENDERER_H_
+#define _RENDERER_H_
+
+//File includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glm.hpp>
+
+#include "Checkpoint.h"
+#include "FlatScene.h"
+#include "Framebuffer.h"
+#include "HitRecord.h"
+#include "Integrator.h"
+#include "PixelEstimate.h"
+#include "RenderSettings.h"
+#include "Scenes.h"
+#include "TaskScheduler.h"
+
+class Renderer
+{
+public:
+	//Variables
+	RenderSettings m_settings;
+	SceneDescription m_description;	//Scene as it was described, its shapes are only read when building m_scene
+	FlatScene m_scene;				//Contiguous primitives and BVH that rays are traced against
+	Framebuffer m_image;
+
+	//Functions
+	Renderer();
+	bool LoadScene(const std::string &_name, TaskScheduler &_scheduler);	//DescribeScene, then BuildAccelerationStructure
+	bool DescribeScene(const std::string &_name);	//Shapes and settings only, false with a message printed if it can't
+	bool BuildAccelerationStructure(TaskScheduler &_scheduler);	//Flattens the shapes and builds the BVH on _scheduler's workers, false with a message printed if it can't
+	bool Resume(const std::string &_path);		//The next Render() carries on from this checkpoint, false with a message printed if it can't
+	void Render(TaskScheduler &_scheduler);		//Sizes m_image from m_settings and renders every tile, in passes if progressive
+	void BeginRender();							//Sizes m_image and clears the estimates, Render() starts with this
+	void RenderRegion(TaskScheduler &_scheduler, int _startX, int _startY, int _width, int _height);	//Every sample of part of the image, after BeginRender()
+	const PixelEstimate &Estimate(int _x, int _y) const;
+	void StoreRegion(int _startX, int _startY, int _width, int _height, const PixelEstimate *_estimates, long long _raysTraced);	//Samples taken elsewhere, row by row
+	bool OutputToImage(const std::string &_path);
+	bool OutputSampleMap(const std::string &_path);	//Greyscale, white where a pixel took m_samplesPerPixel samples
+	long long RaysTraced() const;				//Camera rays and every ray the integrator traced from them in the last Render()
+	double AverageSamplesPerPixel() const;		//Below m_samplesPerPixel when adaptive sampling stopped pixels early
+	bool Finished() const;						//False if the last Render() was cut off by the time limit
+
+private:
+	//Variables
+	std::atomic<long long> m_raysTraced;
+	std::vector<PixelEstimate> m_estimates;	//Every pixel's samples so far, row-major, m_image holds their means
+	std::chrono::steady_clock::time_point m_deadline;	//Tiles stop sampling once this has passed
+	bool m_finished;
+	Framebuffer m_snapshot;				//Copy of m_image being written out while the next pass renders
+	std::thread m_snapshotWriter;
+	std::mutex m_estimatesLock;			//Held while a tile writes back and while a checkpoint copies, so it never sees half a tile
+	int m_endSample;					//Samples per pixel the pass in progress is taking
+	std::vector<char> m_tilesDone;		//Tiles that have finished the pass in progress
+	Checkpoint m_resumeFrom;
+	bool m_resuming;
+	std::mutex m_checkpointLock;
+	std::condition_variable m_checkpointWake;
+	bool m_stopCheckpoints;
+	int m_strataColumns;				//Grid of strata each pixel is split into
+	int m_strataRows;
+	int m_strataStride;					//Step between the strata of consecutive samples, coprime to the number of strata
+	std::unique_ptr<Integrator> m_integrator;	//Colours each camera ray, made by BeginRender() from m_settings
+
+	//Functions
+	glm::vec3 ScreenInitialisation(int _i, int _j, float _offsetX = 0.5f, float _offsetY = 0.5f);
+	glm::vec2 SampleOffset(int _i, int _j, int _sample);
+	glm::vec3 ShootRay(int _i, int _j, int _sample, long long *_secondaryRays);
+	void ShootWavefront(FramebufferTile &_samples, const char *_active, const PixelEstimate *_estimates, long long *_secondaryRays);	//Every active pixel of the tile at once
+	void ShootPacket(int _startX, int _startY, int _endX, int _endY, FramebufferTile &_samples, const char *_active, const PixelEstimate *_estimates, long long *_secondaryRays);
+	void RenderTile(FramebufferTile _tile, int _tileIndex, int _endSample);	//Samples the tile's pixels until each has _endSample samples or has converged, -1 for a tile outside m_tilesDone
+	void Snapshot();										//Writes m_image to m_settings.m_output in the background
+	void SaveCheckpoint();
+	void CheckpointLoop();									//Saves a checkpoint every m_checkpointInterval until m_stopCheckpoints
+};
+
+#endif // _RENDERER_H_
\ No newline at end of file
@@ -0,0 +1,730 @@
+/// @file SceneFile.cpp
+/// @brief Parses each line in place as it streams past, material names are hashed straight from the line
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "FileUtilities.h"
+#include "LineReader.h"
+#include "MappedMesh.h"
+#include "Mesh.h"
+#include "ObjLoader.h"
+#include "Plane.h"
+#include "SceneFile.h"
+#include "Sphere.h"
+
+static const char sceneCacheMagic[8] = { 'R', 'T', 'S', 'C', 'E', 'N', 'E', '3' };	//Last byte is the version
+
+struct SphereRecord
+{
+	glm::vec3 m_centre;
+	float m_radius;
+	int m_material;
+};
+
+struct PlaneRecord
+{
+	glm::vec3 m_point;
+	glm::vec3 m_normal;
+	int m_material;
+};
+
+//Geometry file mapped where it is each time the scene loads, only its name is cached
+struct GeometryRecord
+{
+	std::string m_path;
+	int m_material;
+};
+
+//A file the scene was read from, the cache is stale once any of them change
+struct SourceFile
+{
+	std::string m_path;
+	long long m_size;
+	long long m_modified;
+};
+
+//Scene as read, kept as plain arrays until the shapes are made so it can be cached as it is
+struct ParsedScene
+{
+	std::vector<SourceFile> m_sources;
+	std::vector<Material> m_materials;
+	std::vector<Light> m_lights;
+	Camera m_camera;
+	std::vector<std::string> m_options;
+	std::vector<SphereRecord> m_spheres;
+	std::vector<PlaneRecord> m_planes;
+	std::vector<std::shared_ptr<Mesh>> m_meshes;
+	std::vector<GeometryRecord> m_geometry;
+};
+
+//Arrays of these are cached straight from memory
+static_assert(std::is_trivially_copyable<Material>::value, "Material must be plain data to be cached");
+static_assert(std::is_trivially_copyable<Light>::value, "Light must be plain data to be cached");
+static_assert(std::is_trivially_copyable<SphereRecord>::value, "SphereRecord must be plain data to be cached");
+static_assert(std::is_trivially_copyable<PlaneRecord>::value, "PlaneRecord must be plain data to be cached");
+
+//Open addressing hash from material name to index, looked up with the name where it sits in the line so no string
+//is made for each reference
+class NameTable
+{
+public:
+	//Functions
+	NameTable()
+	{
+		m_slots.assign(64, -1);
+	}
+
+	int Find(const char *_name, size_t _length) const
+	{
+		size_t mask = m_slots.size() - 1;
+		for (size_t slot = Hash(_name, _length) & mask; m_slots[slot] != -1; slot = (slot + 1) & mask)
+		{
+			const std::string &name = m_names[m_slots[slot]];
+			if (name.size() == _length && std::memcmp(name.data(), _name, _length) == 0)
+			{
+				return m_slots[slot];
+			}
+		}
+		return -1;
+	}
+
+	//Names are given indices in the order they are added, a name added again refers to the newer index after
+	void Add(const char *_name, size_t _length)
+	{
+		m_names.push_back(std::string(_name, _length));
+		int index = (int)m_names.size() - 1;
+
+		//Kept under half full so probes stay short
+		if (m_names.size() * 2 > m_slots.size())
+		{
+			m_slots.assign(m_slots.size() * 2, -1);
+			for (int k = 0; k < index; ++k)
+			{
+				Place(k);
+			}
+		}
+		Place(index);
+	}
+
+private:
+	//Variables
+	std::vector<std::string> m_names;
+	std::vector<int> m_slots;	//Index into m_names, -1 for an empty slot
+
+	//Functions
+	//FNV-1a
+	static size_t Hash(const char *_name, size_t _length)
+	{
+		unsigned int hash = 2166136261u;
+		for (size_t c = 0; c < _length; ++c)
+		{
+			hash = (hash ^ (unsigned char)_name[c]) * 16777619u;
+		}
+		return hash;
+	}
+
+	void Place(int _index)
+	{
+		const std::string &name = m_names[_index];
+		size_t mask = m_slots.size() - 1;
+		size_t slot = Hash(name.data(), name.size()) & mask;
+		while (m_slots[slot] != -1 && m_names[m_slots[slot]] != name)
+		{
+			slot = (slot + 1) & mask;
+		}
+		m_slots[slot] = _index;
+	}
+};
+
+static const char *SkipSpace(const char *_text)
+{
+	while (*_text == ' ' || *_text == '\t' || *_text == '\r')
+	{
+		++_text;
+	}
+	return _text;
+}
+
+static const char *TokenEnd(const char *_text)
+{
+	while (*_text != '\0' && *_text != ' ' && *_text != '\t' && *_text != '\r')
+	{
+		++_text;
+	}
+	return _text;
+}
+
+static bool IsKeyword(const char *_token, size_t _length, const char *_keyword)
+{
+	return std::strlen(_keyword) == _length && std::memcmp(_token, _keyword, _length) == 0;
+}
+
+//Reads up to _count numbers, returns how many there were before the end of the line, -1 if something else is in the way
+static int ParseFloats(const char **_text, float *_values, int _count)
+{
+	for (int k = 0; k < _count; ++k)
+	{
+		const char *text = SkipSpace(*_text);
+		if (*text == '\0')
+		{
+			return k;
+		}
+		char *end = nullptr;
+		_values[k] = std::strtof(text, &end);
+		if (end == text)
+		{
+			return -1;
+		}
+		*_text = end;
+	}
+	return _count;
+}
+
+//Splits what follows a settings keyword into command line options
+static void ParseOptions(const char *_text, std::vector<std::string> &_options)
+{
+	while (*(_text = SkipSpace(_text)) != '\0')
+	{
+		const char *end = TokenEnd(_text);
+		_options.push_back(std::string(_text, end));
+		_text = end;
+	}
+}
+
+static bool AddSource(ParsedScene &_scene, const std::string &_path)
+{
+	SourceFile source;
+	source.m_path = _path;
+	if (!FileStatus(_path, &source.m_size, &source.m_modified))
+	{
+		std::cout << "Could not open " << _path << std::endl;
+		return false;
+	}
+	_scene.m_sources.push_back(source);
+	return true;
+}
+
+class SceneParser
+{
+public:
+	//Functions
+	SceneParser(const std::string &_path, ParsedScene &_scene) : m_path(_path), m_directory(DirectoryOf(_path)), m_scene(_scene)
+	{
+	}
+
+	bool ParseLine(char *_line, unsigned int _lineNumber)
+	{
+		m_lineNumber = _lineNumber;
+
+		//Comments end the line wherever they start
+		char *comment = std::strchr(_line, '#');
+		if (comment != nullptr)
+		{
+			*comment = '\0';
+		}
+
+		const char *keyword = SkipSpace(_line);
+		const char *text = TokenEnd(keyword);
+		size_t length = text - keyword;
+		if (length == 0)
+		{
+			return true;
+		}
+
+		//Vertices and faces go to the mesh they follow, in .obj syntax
+		if (IsKeyword(keyword, length, "v") || IsKeyword(keyword, length, "f"))
+		{
+			if (!m_mesh)
+			{
+				return Error("v and f lines belong after a mesh statement");
+			}
+			return ParseOBJLine(_line, *m_mesh, _lineNumber);
+		}
+		m_mesh.reset();
+
+		if (IsKeyword(keyword, length, "camera"))
+		{
+			float values[10] = { 0, 0, 0, 0, 0, -1, 90.0f, 0, 1, 0 };
+			int count = ParseFloats(&text, values, 10);
+			if (count != 6 && count != 7 && count != 10)
+			{
+				return Error("camera needs a position, a point to look at, and optionally a field of view and up direction");
+			}
+			m_scene.m_camera.LookAt(glm::vec3(values[0], values[1], values[2]), glm::vec3(values[3], values[4], values[5]), glm::vec3(values[7], values[8], values[9]), values[6]);
+			return true;
+		}
+
+		if (IsKeyword(keyword, length, "light"))
+		{
+			float values[6] = { 0, 0, 0, 1, 1, 1 };
+			int count = ParseFloats(&text, values, 6);
+			if (count != 3 && count != 6)
+			{
+				return Error("light needs a position and optionally an intensity");
+			}
+			m_scene.m_lights.push_back(Light(glm::vec3(values[0], values[1], values[2]), glm::vec3(values[3], values[4], values[5])));
+			return true;
+		}
+
+		if (IsKeyword(keyword, length, "material"))
+		{
+			const char *name = SkipSpace(text);
+			text = TokenEnd(name);
+			size_t nameLength = text - name;
+			float values[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+			int count = ParseFloats(&text, values, 10);
+			if (nameLength == 0 || (count != 3 && count != 6 && count != 7 && count != 8 && count != 10))
+			{
+				return Error("material needs a name, a diffuse colour, and optionally a specular colour, shine, reflectivity, transparency and refractive index");
+			}
+			if (values[7] < 0.0f || values[7] > 1.0f || values[8] < 0.0f || values[8] > 1.0f || !(values[9] > 0.0f))
+			{
+				return Error("reflectivity and transparency go from 0 to 1, and the refractive index must be above 0");
+			}
+			m_materialNames.Add(name, nameLength);
+			m_scene.m_materials.push_back(Material(glm::vec3(values[0], values[1], values[2]), glm::vec3(values[3], values[4], values[5]), (int)values[6], values[7], values[8], values[9]));
+			m_looseTriangles.push_back(nullptr);
+			return true;
+		}
+
+		if (IsKeyword(keyword, length, "settings"))
+		{
+			ParseOptions(text, m_scene.m_options);
+			return true;
+		}
+
+		//Every shape starts with the name of its material
+		int material = -1;
+		if (!ParseMaterial(&text, &material))
+		{
+			return false;
+		}
+
+		if (IsKeyword(keyword, length, "sphere"))
+		{
+			float values[4];
+			if (ParseFloats(&text, values, 4) != 4 || !(values[3] > 0.0f))
+			{
+				return Error("sphere needs a centre and a radius above 0");
+			}
+			SphereRecord sphere;
+			sphere.m_centre = glm::vec3(values[0], values[1], values[2]);
+			sphere.m_radius = values[3];
+			sphere.m_material = material;
+			m_scene.m_spheres.push_back(sphere);
+			return true;
+		}
+
+		if (IsKeyword(keyword, length, "plane"))
+		{
+			float values[6];
+			if (ParseFloats(&text, values, 6) != 6)
+			{
+				return Error("plane needs a point and a normal");
+			}
+			PlaneRecord plane;
+			plane.m_point = glm::vec3(values[0], values[1], values[2]);
+			plane.m_normal = glm::vec3(values[3], values[4], values[5]);
+			plane.m_material = material;
+			m_scene.m_planes.push_back(plane);
+			return true;
+		}
+
+		if (IsKeyword(keyword, length, "triangle"))
+		{
+			float values[9];
+			if (ParseFloats(&text, values, 9) != 9)
+			{
+				return Error("triangle needs three corners");
+			}
+			std::shared_ptr<Mesh> &mesh = m_looseTriangles[material];
+			if (!mesh)
+			{
+				mesh = std::make_shared<Mesh>(material);
+				m_scene.m_meshes.push_back(mesh);
+			}
+			unsigned int first = (unsigned int)mesh->m_vertices.size();
+			for (int corner = 0; corner < 3; ++corner)
+			{
+				mesh->m_vertices.push_back(glm::vec3(values[corner * 3], values[corner * 3 + 1], values[corner * 3 + 2]));
+			}
+			mesh->AddTriangle(first, first + 1, first + 2);
+			return true;
+		}
+
+		if (IsKeyword(keyword, length, "mesh"))
+		{
+			m_mesh = std::make_shared<Mesh>(material);
+			m_scene.m_meshes.push_back(m_mesh);
+			return true;
+		}
+
+		if (IsKeyword(keyword, length, "obj"))
+		{
+			std::string path;
+			if (!ParsePath(text, &path))
+			{
+				return Error("obj needs a file");
+			}
+			std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(material);
+			if (!AddSource(m_scene, path) || !LoadOBJ(path, *mesh))
+			{
+				return false;
+			}
+			m_scene.m_meshes.push_back(mesh);
+			return true;
+		}
+
+		if (IsKeyword(keyword, length, "geometry"))
+		{
+			GeometryRecord geometry;
+			if (!ParsePath(text, &geometry.m_path))
+			{
+				return Error("geometry needs a file");
+			}
+			geometry.m_material = material;
+			m_scene.m_geometry.push_back(geometry);
+			return true;
+		}
+
+		return Error("unknown statement");
+	}
+
+private:
+	//Variables
+	std::string m_path;
+	std::string m_directory;						//Of the scene file, .obj paths are relative to it
+	ParsedScene &m_scene;
+	NameTable m_materialNames;
+	std::vector<std::shared_ptr<Mesh>> m_looseTriangles;	//Per material, the mesh its triangle statements go into
+	std::shared_ptr<Mesh> m_mesh;					//Mesh the v and f lines are going into
+	unsigned int m_lineNumber;
+
+	//Functions
+	bool Error(const char *_message) const
+	{
+		std::cout << m_path << " line " << m_lineNumber << ": " << _message << std::endl;
+		return false;
+	}
+
+	//Rest of the line, so paths can have spaces in them, relative to the scene file unless absolute
+	bool ParsePath(const char *_text, std::string *_path) const
+	{
+		const char *start = SkipSpace(_text);
+		const char *end = start + std::strlen(start);
+		while (end > start && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+		{
+			--end;
+		}
+		if (end == start)
+		{
+			return false;
+		}
+
+		*_path = std::string(start, end);
+		if ((*_path)[0] != '/' && (*_path)[0] != '\\' && _path->find(':') == std::string::npos)
+		{
+			*_path = m_directory + *_path;
+		}
+		return true;
+	}
+
+	bool ParseMaterial(const char **_text, int *_material)
+	{
+		const char *name = SkipSpace(*_text);
+		const char *end = TokenEnd(name);
+		*_material = m_materialNames.Find(name, end - name);
+		if (*_material == -1)
+		{
+			std::cout << m_path << " line " << m_lineNumber << ": unknown material \"" << std::string(name, end) << "\"" << std::endl;
+			return false;
+		}
+		*_text = end;
+		return true;
+	}
+};
+
+template <typename T>
+static void WriteValue(std::ofstream &_ofs, const T &_value)
+{
+	_ofs.write((const char *)&_value, sizeof(T));
+}
+
+template <typename T>
+static bool ReadValue(std::ifstream &_ifs, T *_value)
+{
+	return (bool)_ifs.read((char *)_value, sizeof(T));
+}
+
+template <typename T>
+static void WriteArray(std::ofstream &_ofs, const std::vector<T> &_values)
+{
+	WriteValue(_ofs, (long long)_values.size());
+	_ofs.write((const char *)_values.data(), _values.size() * sizeof(T));
+}
+
+template <typename T>
+static bool ReadArray(std::ifstream &_ifs, std::vector<T> *_values)
+{
+	long long count = 0;
+	if (!ReadValue(_ifs, &count) || count < 0 || count > (1LL << 40) / (long long)sizeof(T))
+	{
+		return false;
+	}
+	_values->resize((size_t)count);
+	return (bool)_ifs.read((char *)_values->data(), count * sizeof(T));
+}
+
+static void WriteString(std::ofstream &_ofs, const std::string &_text)
+{
+	WriteValue(_ofs, (int)_text.size());
+	_ofs.write(_text.data(), _text.size());
+}
+
+static bool ReadString(std::ifstream &_ifs, std::string *_text)
+{
+	int length = 0;
+	if (!ReadValue(_ifs, &length) || length < 0 || length > 65536)
+	{
+		return false;
+	}
+	_text->resize(length);
+	return length == 0 || (bool)_ifs.read(&(*_text)[0], length);
+}
+
+static bool WriteCache(const std::string &_path, const ParsedScene &_scene)
+{
+	std::string partial = _path + ".part";
+	std::ofstream ofs(partial.c_str(), std::ios::out | std::ios::binary);
+	if (!ofs)
+	{
+		return false;
+	}
+
+	ofs.write(sceneCacheMagic, sizeof(sceneCacheMagic));
+	WriteValue(ofs, (int)_scene.m_sources.size());
+	for (const SourceFile &source : _scene.m_sources)
+	{
+		WriteString(ofs, source.m_path);
+		WriteValue(ofs, source.m_size);
+		WriteValue(ofs, source.m_modified);
+	}
+
+	const Camera &camera = _scene.m_camera;
+	WriteValue(ofs, camera.Position());
+	WriteValue(ofs, camera.Target());
+	WriteValue(ofs, camera.Up());
+	WriteValue(ofs, camera.FieldOfView());
+	WriteValue(ofs, (int)_scene.m_options.size());
+	for (const std::string &option : _scene.m_options)
+	{
+		WriteString(ofs, option);
+	}
+	WriteArray(ofs, _scene.m_lights);
+	WriteArray(ofs, _scene.m_materials);
+	WriteArray(ofs, _scene.m_spheres);
+	WriteArray(ofs, _scene.m_planes);
+	WriteValue(ofs, (int)_scene.m_meshes.size());
+	for (const std::shared_ptr<Mesh> &mesh : _scene.m_meshes)
+	{
+		WriteValue(ofs, mesh->m_material);
+		WriteArray(ofs, mesh->m_vertices);
+		WriteArray(ofs, mesh->m_indices);
+	}
+	WriteValue(ofs, (int)_scene.m_geometry.size());
+	for (const GeometryRecord &geometry : _scene.m_geometry)
+	{
+		WriteString(ofs, geometry.m_path);
+		WriteValue(ofs, geometry.m_material);
+	}
+
+	ofs.close();
+	return !ofs.fail() && ReplaceFile(partial, _path);
+}
+
+//False without a message if there is no cache or it is out of date, the scene is parsed again
+static bool ReadCache(const std::string &_path, ParsedScene &_scene)
+{
+	std::ifstream ifs(_path.c_str(), std::ios::in | std::ios::binary);
+	char magic[sizeof(sceneCacheMagic)];
+	if (!ifs || !ifs.read(magic, sizeof(magic)) || std::memcmp(magic, sceneCacheMagic, sizeof(magic)) != 0)
+	{
+		return false;
+	}
+
+	int numberOfSources = 0;
+	if (!ReadValue(ifs, &numberOfSources) || numberOfSources < 0)
+	{
+		return false;
+	}
+	for (int s = 0; s < numberOfSources; ++s)
+	{
+		SourceFile source;
+		long long size = 0;
+		long long modified = 0;
+		if (!ReadString(ifs, &source.m_path) || !ReadValue(ifs, &source.m_size) || !ReadValue(ifs, &source.m_modified) ||
+			!FileStatus(source.m_path, &size, &modified) || size != source.m_size || modified != source.m_modified)
+		{
+			return false;
+		}
+		_scene.m_sources.push_back(source);
+	}
+
+	glm::vec3 position;
+	glm::vec3 target;
+	glm::vec3 up;
+	float fieldOfView = 0.0f;
+	int numberOfOptions = 0;
+	bool valid = ReadValue(ifs, &position) && ReadValue(ifs, &target) && ReadValue(ifs, &up) && ReadValue(ifs, &fieldOfView) &&
+		ReadValue(ifs, &numberOfOptions) && numberOfOptions >= 0;
+	for (int o = 0; valid && o < numberOfOptions; ++o)
+	{
+		std::string option;
+		valid = ReadString(ifs, &option);
+		_scene.m_options.push_back(option);
+	}
+	valid = valid && ReadArray(ifs, &_scene.m_lights) && ReadArray(ifs, &_scene.m_materials) &&
+		ReadArray(ifs, &_scene.m_spheres) && ReadArray(ifs, &_scene.m_planes);
+
+	int numberOfMeshes = 0;
+	valid = valid && ReadValue(ifs, &numberOfMeshes) && numberOfMeshes >= 0;
+	for (int m = 0; valid && m < numberOfMeshes; ++m)
+	{
+		int material = 0;
+		valid = ReadValue(ifs, &material);
+		std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(material);
+		valid = valid && ReadArray(ifs, &mesh->m_vertices) && ReadArray(ifs, &mesh->m_indices);
+		_scene.m_meshes.push_back(mesh);
+	}
+
+	int numberOfGeometry = 0;
+	valid = valid && ReadValue(ifs, &numberOfGeometry) && numberOfGeometry >= 0;
+	for (int g = 0; valid && g < numberOfGeometry; ++g)
+	{
+		GeometryRecord geometry;
+		valid = ReadString(ifs, &geometry.m_path) && ReadValue(ifs, &geometry.m_material);
+		_scene.m_geometry.push_back(geometry);
+	}
+
+	if (valid)
+	{
+		_scene.m_camera.LookAt(position, target, up, fieldOfView);
+	}
+	return valid;
+}
+
+static bool ParseSceneFile(const std::string &_path, ParsedScene &_scene)
+{
+	if (!AddSource(_scene, _path))
+	{
+		return false;
+	}
+
+	SceneParser parser(_path, _scene);
+	bool valid = ReadLines(_path, [&parser](char *_line, unsigned int _lineNumber)
+	{
+		return parser.ParseLine(_line, _lineNumber);
+	});
+	if (!valid)
+	{
+		return false;
+	}
+
+	//Shapes can only refer to materials that were defined, but check what the cache will be trusted with
+	for (const std::shared_ptr<Mesh> &mesh : _scene.m_meshes)
+	{
+		for (unsigned int index : mesh->m_indices)
+		{
+			if (index >= mesh->m_vertices.size())
+			{
+				std::cout << _path << ": mesh refers to a missing vertex" << std::endl;
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool LoadSceneFile(const std::string &_path, SceneDescription &_scene)
+{
+	std::string cachePath = _path + ".cache";
+	ParsedScene parsed;
+	bool cached = ReadCache(cachePath, parsed);
+	if (!cached)
+	{
+		parsed = ParsedScene();
+		if (!ParseSceneFile(_path, parsed))
+		{
+			return false;
+		}
+		if (!WriteCache(cachePath, parsed))
+		{
+			std::cout << "Could not write scene cache " << cachePath << std::endl;
+		}
+	}
+
+	_scene.m_materials.swap(parsed.m_materials);
+	_scene.m_lights.swap(parsed.m_lights);
+	_scene.m_camera = parsed.m_camera;
+	_scene.m_options.swap(parsed.m_options);
+
+	//Only now are the primitives made into shapes
+	size_t numberOfTriangles = 0;
+	_scene.m_listOfShapes.reserve(_scene.m_listOfShapes.size() + parsed.m_spheres.size() + parsed.m_planes.size() + parsed.m_meshes.size());
+	for (const PlaneRecord &plane : parsed.m_planes)
+	{
+		_scene.m_listOfShapes.push_back(std::make_shared<Plane>(plane.m_point, plane.m_normal, plane.m_material));
+	}
+	for (const SphereRecord &sphere : parsed.m_spheres)
+	{
+		_scene.m_listOfShapes.push_back(std::make_shared<Sphere>(sphere.m_centre, sphere.m_radius, sphere.m_material));
+	}
+	for (const std::shared_ptr<Mesh> &mesh : parsed.m_meshes)
+	{
+		if (mesh->NumberOfTriangles() > 0)
+		{
+			_scene.m_listOfShapes.push_back(mesh);
+			numberOfTriangles += mesh->NumberOfTriangles();
+		}
+	}
+	for (const GeometryRecord &geometry : parsed.m_geometry)
+	{
+		std::shared_ptr<MappedMesh> mesh = std::make_shared<MappedMesh>(geometry.m_material);
+		if (!mesh->Open(geometry.m_path))
+		{
+			return false;
+		}
+		_scene.m_listOfShapes.push_back(mesh);
+		numberOfTriangles += mesh->NumberOfTriangles();
+	}
+
+	std::cout << "Loaded " << _path << (cached ? " from its cache" : "") << ": " << parsed.m_spheres.size() << " spheres, "
+		<< parsed.m_planes.size() << " planes, " << numberOfTriangles << " triangles, " << _scene.m_lights.size() << " lights" << std::endl;
+	return true;
+}
+
+bool LoadSceneFileOptions(const std::string &_path, std::vector<std::string> &_options)
+{
+	//Every other statement is skipped unparsed, nothing else in the file is checked
+	return ReadLines(_path, [&_options](char *_line, unsigned int)
+	{
+		char *comment = std::strchr(_line, '#');
+		if (comment != nullptr)
+		{
+			*comment = '\0';
+		}
+		const char *keyword = SkipSpace(_line);
+		const char *text = TokenEnd(keyword);
+		if (IsKeyword(keyword, text - keyword, "settings"))
+		{
+			ParseOptions(text, _options);
+		}
+		return true;
+	});
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+/// \file SceneFile.h
+/// \brief text scene description, streamed line by line, with a binary cache beside it so repeat loads skip parsing
+/// \author Josh Bailey
+
+#ifndef _SCENEFILE_H_
+#define _SCENEFILE_H_
+
+//File includes
+#include <string>
+#include <vector>
+
+#include "Scenes.h"
+
+//One statement per line, numbers separated by spaces, anything after # is a comment:
+//  camera   px py pz  tx ty tz  [fov [ux uy uz]]	placed at p looking at t, fov in degrees (90), up (0 1 0)
+//  light    px py pz  [r g b]						point light, intensity (1 1 1)
+//  material NAME  dr dg db  [sr sg sb  [shine  [reflectivity  [transparency ior]]]]
+//													diffuse, specular (0 0 0), shine (0), mirror reflectivity (0),
+//													transparency (0) and refractive index (1), see Material.h
+//  sphere   MATERIAL  cx cy cz  radius
+//  plane    MATERIAL  px py pz  nx ny nz
+//  triangle MATERIAL  ax ay az  bx by bz  cx cy cz	loose triangles of one material share a mesh
+//  mesh     MATERIAL								the v and f lines that follow, as in a .obj, make up this mesh
+//  obj      MATERIAL  FILE							a .obj file, relative to the scene file, used as it is
+//  geometry MATERIAL  FILE							a geometry file (see GeometryFile.h) mapped and traced in place
+//  settings OPTIONS...							command line options, e.g. settings --width 1920 --spp 16
+//FILE.cache is written after the first load and read instead while FILE and the .obj files it names are unchanged,
+//false with a message printed if the file can't be read
+bool LoadSceneFile(const std::string &_path, SceneDescription &_scene);
+
+//Only the options of the settings lines, for a coordinator that never loads the scene itself
+bool LoadSceneFileOptions(const std::string &_path, std::vector<std::string> &_options);
+
+#endif // _SCENEFILE_H_
\ No newline at end of file
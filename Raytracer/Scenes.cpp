@@ -0,0 +1,179 @@
+/// @file Scenes.cpp
+/// @brief Builds the shapes for each built-in scene
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "MappedMesh.h"
+#include "Mesh.h"
+#include "ObjLoader.h"
+#include "Plane.h"
+#include "SceneFile.h"
+#include "Scenes.h"
+#include "Sphere.h"
+
+//Adds a material to the scene and returns its index for shapes to use
+static int AddMaterial(std::vector<Material> &_materials, glm::vec3 _diffuse, glm::vec3 _specular, int _shine)
+{
+	_materials.push_back(Material(_diffuse, _specular, _shine));
+	return (int)_materials.size() - 1;
+}
+
+//Matte like floor surface, dull diffuse with no glow
+static int AddFloorMaterial(std::vector<Material> &_materials)
+{
+	return AddMaterial(_materials, glm::vec3(0.35f, 0.35f, 0.35f), glm::vec3(0.2f, 0.2f, 0.2f), 0);	//Dark Grey
+}
+
+//Shaded colour with a light grey glow, polished enough to mirror its surroundings once --depth allows reflections
+static int AddSphereMaterial(std::vector<Material> &_materials, glm::vec3 _colour)
+{
+	_materials.push_back(Material(_colour, glm::vec3(0.65f, 0.65f, 0.76f), 128, 0.25f, 0.0f, 1.0f));
+	return (int)_materials.size() - 1;
+}
+
+static void InstantiateDefault(SceneDescription &_scene)
+{
+	_scene.m_listOfShapes.push_back(std::make_shared<Plane>(glm::vec3(0, -5, 0), glm::vec3(0, 1, 0), AddFloorMaterial(_scene.m_materials)));						//Floor - Dark Grey
+	_scene.m_listOfShapes.push_back(std::make_shared<Sphere>(glm::vec3(-10, 0, -20), 4.0f, AddSphereMaterial(_scene.m_materials, glm::vec3(1, 0.35f, 0.35f))));	//Sphere - Red
+	_scene.m_listOfShapes.push_back(std::make_shared<Sphere>(glm::vec3(1, 0, -20), 3.0f, AddSphereMaterial(_scene.m_materials, glm::vec3(0.35f, 1, 0.35f))));		//Sphere - Green
+	_scene.m_listOfShapes.push_back(std::make_shared<Sphere>(glm::vec3(9, 0, -20), 2.0f, AddSphereMaterial(_scene.m_materials, glm::vec3(0.35f, 0.35f, 1))));		//Sphere - Blue
+	_scene.m_listOfShapes.push_back(std::make_shared<Sphere>(glm::vec3(14, 0, -20), 1.0f, AddSphereMaterial(_scene.m_materials, glm::vec3(1, 1, 0.35f))));		//Sphere - Yellow
+}
+
+static void InstantiateParticles(SceneDescription &_scene, int _numberOfSpheres)
+{
+	_scene.m_listOfShapes.push_back(std::make_shared<Plane>(glm::vec3(0, -5, 0), glm::vec3(0, 1, 0), AddFloorMaterial(_scene.m_materials)));	//Floor - Dark Grey
+
+	//Fixed seed so every run (and every benchmark) renders the same scene
+	std::mt19937 generator(2018);
+	std::uniform_real_distribution<float> spreadX(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> spreadY(-5.0f, 15.0f);
+	std::uniform_real_distribution<float> spreadZ(-60.0f, -15.0f);
+	std::uniform_real_distribution<float> colour(0.2f, 1.0f);
+
+	//Particles shrink as there are more of them so the volume stays about as full
+	float radius = glm::clamp(3.0f / std::cbrt((float)_numberOfSpheres), 0.01f, 2.0f);
+	std::uniform_real_distribution<float> size(0.5f * radius, 1.5f * radius);
+
+	_scene.m_listOfShapes.reserve(_scene.m_listOfShapes.size() + _numberOfSpheres);
+	_scene.m_materials.reserve(_scene.m_materials.size() + _numberOfSpheres);
+	for (int k = 0; k < _numberOfSpheres; ++k)
+	{
+		//One draw per statement, argument evaluation order would make the scene depend on the compiler
+		glm::vec3 position;
+		position.x = spreadX(generator);
+		position.y = spreadY(generator);
+		position.z = spreadZ(generator);
+		float radius = size(generator);
+		glm::vec3 diffuse;
+		diffuse.r = colour(generator);
+		diffuse.g = colour(generator);
+		diffuse.b = colour(generator);
+		_scene.m_listOfShapes.push_back(std::make_shared<Sphere>(position, radius, AddSphereMaterial(_scene.m_materials, diffuse)));
+	}
+}
+
+//Light grey with a softer highlight than the spheres
+static int AddModelMaterial(std::vector<Material> &_materials)
+{
+	return AddMaterial(_materials, glm::vec3(0.8f, 0.8f, 0.8f), glm::vec3(0.5f, 0.5f, 0.5f), 32);
+}
+
+static bool InstantiateOBJ(SceneDescription &_scene, const std::string &_path)
+{
+	std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(AddModelMaterial(_scene.m_materials));
+	if (!LoadOBJ(_path, *mesh))
+	{
+		return false;
+	}
+
+	//Models come in any size, fit the largest side to 14 units standing on the floor where the default spheres are
+	AABB bounds;
+	for (const glm::vec3 &vertex : mesh->m_vertices)
+	{
+		bounds.Grow(vertex);
+	}
+	glm::vec3 extent = bounds.m_max - bounds.m_min;
+	float scale = 14.0f / glm::max(glm::max(extent.x, extent.y), glm::max(extent.z, 1e-6f));
+	glm::vec3 centre = bounds.Centroid();
+	mesh->Transform(glm::vec3(scale), glm::vec3(-centre.x * scale, -5.0f - bounds.m_min.y * scale, -20.0f - centre.z * scale));
+
+	_scene.m_listOfShapes.push_back(std::make_shared<Plane>(glm::vec3(0, -5, 0), glm::vec3(0, 1, 0), AddFloorMaterial(_scene.m_materials)));	//Floor - Dark Grey
+	_scene.m_listOfShapes.push_back(mesh);
+	std::cout << "Loaded " << _path << ": " << mesh->m_vertices.size() << " vertices, " << mesh->NumberOfTriangles() << " triangles" << std::endl;
+	return true;
+}
+
+//Used as it was written, --write-geometry from an obj: scene already stands it on the floor
+static bool InstantiateGeometry(SceneDescription &_scene, const std::string &_path)
+{
+	std::shared_ptr<MappedMesh> mesh = std::make_shared<MappedMesh>(AddModelMaterial(_scene.m_materials));
+	if (!mesh->Open(_path))
+	{
+		return false;
+	}
+
+	_scene.m_listOfShapes.push_back(std::make_shared<Plane>(glm::vec3(0, -5, 0), glm::vec3(0, 1, 0), AddFloorMaterial(_scene.m_materials)));	//Floor - Dark Grey
+	_scene.m_listOfShapes.push_back(mesh);
+	std::cout << "Mapped " << _path << ": " << mesh->NumberOfTriangles() << " triangles" << std::endl;
+	return true;
+}
+
+static bool IsSceneFile(const std::string &_name)
+{
+	const std::string extension = ".scene";
+	return _name.size() > extension.size() && _name.compare(_name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+bool InstantiateScene(const std::string &_name, SceneDescription &_scene)
+{
+	//Scene files bring their own lights and camera
+	if (IsSceneFile(_name))
+	{
+		return LoadSceneFile(_name, _scene);
+	}
+
+	//Built-in scenes are lit by the original light and seen from the original camera
+	_scene.m_lights.push_back(Light(glm::vec3(20, 20, 0), glm::vec3(1, 1, 1)));
+
+	if (_name == "default")
+	{
+		InstantiateDefault(_scene);
+		return true;
+	}
+
+	if (_name.compare(0, 10, "particles:") == 0)
+	{
+		int numberOfSpheres = std::atoi(_name.c_str() + 10);
+		if (numberOfSpheres > 0)
+		{
+			InstantiateParticles(_scene, numberOfSpheres);
+			return true;
+		}
+	}
+
+	if (_name.compare(0, 4, "obj:") == 0)
+	{
+		return InstantiateOBJ(_scene, _name.substr(4));
+	}
+
+	if (_name.compare(0, 4, "geo:") == 0)
+	{
+		return InstantiateGeometry(_scene, _name.substr(4));
+	}
+
+	std::cout << "Unknown scene: " << _name << std::endl;
+	return false;
+}
+
+bool SceneOptions(const std::string &_name, std::vector<std::string> &_options)
+{
+	//Built-in scenes ask for nothing
+	if (IsSceneFile(_name))
+	{
+		return LoadSceneFileOptions(_name, _options);
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+/// \file Scenes.h
+/// \brief built-in scenes that can be picked by name from the command line
+/// \author Josh Bailey
+
+#ifndef _SCENES_H_
+#define _SCENES_H_
+
+//File includes
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Camera.h"
+#include "Light.h"
+#include "Material.h"
+#include "Shape.h"
+
+//Everything a scene says about itself
+struct SceneDescription
+{
+	//Variables
+	std::vector<std::shared_ptr<Shape>> m_listOfShapes;	//Only read when building the FlatScene
+	std::vector<Material> m_materials;					//Indexed by Shape::m_material
+	std::vector<Light> m_lights;
+	Camera m_camera;
+	std::vector<std::string> m_options;					//Command line options the scene asks for, the real command line overrides them
+
+	//Functions
+	void Clear()
+	{
+		m_listOfShapes.clear();
+		m_materials.clear();
+		m_lights.clear();
+		m_camera = Camera();
+		m_options.clear();
+	}
+};
+
+//"default" is the original five shape scene, "particles:N" is N random spheres above the floor,
+//"obj:FILE" is a Wavefront .obj model scaled to stand on the floor, "geo:FILE" is a geometry file (see GeometryFile.h)
+//mapped above the same floor, "FILE.scene" is a scene file (see SceneFile.h)
+bool InstantiateScene(const std::string &_name, SceneDescription &_scene);
+
+//Just the options the scene asks for, without loading anything else, false with a message printed if it can't be read
+bool SceneOptions(const std::string &_name, std::vector<std::string> &_options);
+
+#endif // _SCENES_H_
\ No newline at end of file
@@ -0,0 +1,636 @@
+/// @file SelfTest.cpp
+/// @brief Compares exactly, a fast path that gives a slightly different tree, hit or pixel is a failure however close it is,
+/// unless it is known to sum the same terms in another order
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "AlignedMemory.h"
+#include "BVH.h"
+#include "Checkpoint.h"
+#include "CompressedBVH.h"
+#include "GeometryFile.h"
+#include "MappedMesh.h"
+#include "Random.h"
+#include "Renderer.h"
+#include "SceneFile.h"
+#include "SelfTest.h"
+#include "TaskScheduler.h"
+#include "WideBVH.h"
+
+//Counts the checks as they are reported
+struct SelfTestResults
+{
+	int m_checks;
+	int m_failures;
+};
+
+static void Report(SelfTestResults &_results, bool _passed, const std::string &_name)
+{
+	++_results.m_checks;
+	if (!_passed)
+	{
+		++_results.m_failures;
+	}
+	std::cout << (_passed ? "  pass  " : "  FAIL  ") << _name << std::endl;
+}
+
+//Boxes of up to 2 units scattered through a 100 unit cube, the same ones for a given seed
+static std::vector<AABB> RandomBoxes(int _count, uint64_t _seed)
+{
+	PCG32 random(_seed, 1);
+	std::vector<AABB> boxes(_count);
+	for (AABB &box : boxes)
+	{
+		glm::vec3 corner = glm::vec3(random.NextFloat(), random.NextFloat(), random.NextFloat()) * 100.0f;
+		glm::vec3 size = glm::vec3(random.NextFloat(), random.NextFloat(), random.NextFloat()) * 2.0f;
+		box = AABB(corner, corner + size);
+	}
+	return boxes;
+}
+
+//The parallel build promises the sequential tree node for node, not just one as good
+static void CheckParallelBuild(SelfTestResults &_results, TaskScheduler &_scheduler)
+{
+	const int sizes[] = { 1, 5, 1000, 100000 };	//The last is big enough for the top levels to be binned by every worker
+	for (int size : sizes)
+	{
+		std::vector<AABB> boxes = RandomBoxes(size, size);
+		BVH sequential;
+		sequential.Build(boxes);
+		BVH parallel;
+		parallel.Build(boxes, _scheduler);
+
+		bool same = sequential.m_nodes.size() == parallel.m_nodes.size() && sequential.m_primitives == parallel.m_primitives &&
+			std::memcmp(sequential.m_nodes.data(), parallel.m_nodes.data(), sequential.m_nodes.size() * sizeof(BVHNode)) == 0;
+		Report(_results, same, "parallel BVH build over " + std::to_string(size) + " boxes matches the sequential build with " +
+			std::to_string(_scheduler.NumberOfWorkers()) + " workers");
+	}
+}
+
+//Decoded the way CompressedBVHNode::Intersection decodes it
+static AABB CompressedSlot(const CompressedBVHNode &_node, int _slot)
+{
+	glm::vec3 step = glm::vec3(CompressedBVHNode::Step(_node.m_exponent[0]), CompressedBVHNode::Step(_node.m_exponent[1]), CompressedBVHNode::Step(_node.m_exponent[2]));
+	glm::vec3 corner = glm::vec3(_node.m_origin[0], _node.m_origin[1], _node.m_origin[2]);
+	glm::vec3 lowest = glm::vec3((float)_node.m_minX[_slot], (float)_node.m_minY[_slot], (float)_node.m_minZ[_slot]) * step + corner;
+	glm::vec3 highest = glm::vec3((float)_node.m_maxX[_slot], (float)_node.m_maxY[_slot], (float)_node.m_maxZ[_slot]) * step + corner;
+	return AABB(lowest, highest);
+}
+
+//Grows _contents by every box under the node, false if any slot is smaller than what it holds
+static bool CompressedCovers(const CompressedBVH &_compressed, int _node, const BVH &_bvh, const std::vector<AABB> &_boxes, AABB *_contents)
+{
+	const CompressedBVHNode &node = _compressed.m_nodes[_node];
+	bool covers = true;
+	for (int k = 0; k < node.m_numberOfChildren; ++k)
+	{
+		AABB contents;
+		if (node.m_count[k] == 0)
+		{
+			covers = CompressedCovers(_compressed, node.m_child[k], _bvh, _boxes, &contents) && covers;
+		}
+		else
+		{
+			for (int p = node.m_child[k]; p < node.m_child[k] + node.m_count[k]; ++p)
+			{
+				contents.Grow(_boxes[_bvh.m_primitives[p]]);
+			}
+		}
+
+		AABB slot = CompressedSlot(node, k);
+		covers = covers && glm::all(glm::lessThanEqual(slot.m_min, contents.m_min)) && glm::all(glm::greaterThanEqual(slot.m_max, contents.m_max));
+		_contents->Grow(contents);
+	}
+	return covers;
+}
+
+//A node's box is the union of its children's, so pruning by it can't skip a box the ray hits, and each tree must find
+//exactly the distance testing every box finds
+static void CheckTraversals(SelfTestResults &_results)
+{
+	std::vector<AABB> boxes = RandomBoxes(20000, 7);
+	BVH bvh;
+	bvh.Build(boxes);
+	WideBVH wide;
+	wide.Build(bvh);
+	CompressedBVH compressed;
+	compressed.Build(bvh);
+
+	AABB contents;
+	Report(_results, CompressedCovers(compressed, 0, bvh, boxes, &contents), "every quantised compressed BVH box contains the boxes under it");
+
+	PCG32 random(11, 2);
+	int closestMismatches = 0;
+	int occludedMismatches = 0;
+	int wideClosestMismatches = 0;
+	int wideOccludedMismatches = 0;
+	int compressedClosestMismatches = 0;
+	int compressedOccludedMismatches = 0;
+	const int numberOfRays = 4000;
+	for (int r = 0; r < numberOfRays; ++r)
+	{
+		//From anywhere around the cube towards somewhere inside it
+		glm::vec3 origin = glm::vec3(random.NextFloat(), random.NextFloat(), random.NextFloat()) * 140.0f - 20.0f;
+		glm::vec3 target = glm::vec3(random.NextFloat(), random.NextFloat(), random.NextFloat()) * 100.0f;
+		glm::vec3 direction = glm::normalize(target - origin);
+		glm::vec3 inverseDirection = 1.0f / direction;
+
+		auto intersectLeaf = [&](int first, int count, float *leafMinT, int *leafHitPrimitive)
+		{
+			bool hitLeaf = false;
+			for (int k = first; k < first + count; ++k)
+			{
+				float t = 0.0f;
+				if (boxes[bvh.m_primitives[k]].Intersection(&t, origin, inverseDirection, *leafMinT) && t < *leafMinT)
+				{
+					*leafMinT = t;
+					*leafHitPrimitive = bvh.m_primitives[k];
+					hitLeaf = true;
+				}
+			}
+			return hitLeaf;
+		};
+		const float maxT = 40.0f;
+		auto occludedLeaf = [&](int first, int count)
+		{
+			for (int k = first; k < first + count; ++k)
+			{
+				float t = 0.0f;
+				if (boxes[bvh.m_primitives[k]].Intersection(&t, origin, inverseDirection, maxT))
+				{
+					return true;
+				}
+			}
+			return false;
+		};
+
+		//Every box, in no particular order
+		float expectedT = INFINITY;
+		int primitive = -1;
+		bool expectedHit = intersectLeaf(0, (int)boxes.size(), &expectedT, &primitive);
+		bool expectedOccluded = occludedLeaf(0, (int)boxes.size());
+
+		float binaryT = INFINITY;
+		bool binaryHit = bvh.Intersection(&binaryT, &primitive, origin, direction, intersectLeaf);
+		if (binaryHit != expectedHit || binaryT != expectedT)
+		{
+			++closestMismatches;
+		}
+		if (bvh.Occluded(origin, direction, maxT, occludedLeaf) != expectedOccluded)
+		{
+			++occludedMismatches;
+		}
+
+		float wideT = INFINITY;
+		bool wideHit = wide.Intersection(&wideT, &primitive, origin, direction, intersectLeaf);
+		if (wideHit != expectedHit || wideT != expectedT)
+		{
+			++wideClosestMismatches;
+		}
+		if (wide.Occluded(origin, direction, maxT, occludedLeaf) != expectedOccluded)
+		{
+			++wideOccludedMismatches;
+		}
+
+		//Boxes rounded outwards only let more nodes through, never fewer
+		float compressedT = INFINITY;
+		bool compressedHit = compressed.Intersection(&compressedT, &primitive, origin, direction, intersectLeaf);
+		if (compressedHit != expectedHit || compressedT != expectedT)
+		{
+			++compressedClosestMismatches;
+		}
+		if (compressed.Occluded(origin, direction, maxT, occludedLeaf) != expectedOccluded)
+		{
+			++compressedOccludedMismatches;
+		}
+	}
+	Report(_results, closestMismatches == 0, "BVH finds the closest of every box for " + std::to_string(numberOfRays) + " rays (" + std::to_string(closestMismatches) + " differ)");
+	Report(_results, occludedMismatches == 0, "BVH agrees with every box on occlusion for " + std::to_string(numberOfRays) + " rays (" + std::to_string(occludedMismatches) + " differ)");
+	Report(_results, wideClosestMismatches == 0, "wide BVH finds the closest of every box for " + std::to_string(numberOfRays) + " rays (" + std::to_string(wideClosestMismatches) + " differ)");
+	Report(_results, wideOccludedMismatches == 0, "wide BVH agrees with every box on occlusion for " + std::to_string(numberOfRays) + " rays (" + std::to_string(wideOccludedMismatches) + " differ)");
+	Report(_results, compressedClosestMismatches == 0, "compressed BVH finds the closest of every box for " + std::to_string(numberOfRays) + " rays (" + std::to_string(compressedClosestMismatches) + " differ)");
+	Report(_results, compressedOccludedMismatches == 0, "compressed BVH agrees with every box on occlusion for " + std::to_string(numberOfRays) + " rays (" + std::to_string(compressedOccludedMismatches) + " differ)");
+}
+
+static bool WriteText(const std::string &_path, const std::string &_text)
+{
+	std::ofstream ofs(_path.c_str(), std::ios::out | std::ios::binary);
+	ofs << _text;
+	ofs.close();
+	return !ofs.fail();
+}
+
+//Options that must each be refused rather than rendered with
+static void CheckOptions(SelfTestResults &_results)
+{
+	const std::vector<std::string> refused[] = {
+		{ "--width", "0" },
+		{ "--spp", "many" },
+		{ "--width", "46341", "--height", "46341" },	//More pixels than an int numbers
+		{ "--threads" }
+	};
+	for (const std::vector<std::string> &options : refused)
+	{
+		std::string name;
+		for (const std::string &option : options)
+		{
+			name += " " + option;
+		}
+		RenderSettings settings;
+		Report(_results, !settings.ParseOptions(options), "options" + name + " are refused");
+	}
+}
+
+//Checkpoints are read back field for field, and one cut short or inconsistent with itself is refused rather than
+//resumed from
+static void CheckCheckpoint(SelfTestResults &_results, const std::string &_path)
+{
+	RenderSettings settings;
+	settings.m_imageWidth = 5;
+	settings.m_imageHeight = 3;
+	settings.m_tileSize = 2;
+	settings.m_samplesPerPixel = 16;
+	settings.m_adaptiveThreshold = 0.02f;
+	settings.m_integrator = integratorPath;
+	settings.m_scene = "particles:10";
+
+	Checkpoint written;
+	written.Describe(settings);
+	written.m_endSample = 8;
+	written.m_tilesDone = { 1, 0, 1, 0, 0, 1 };
+	written.m_estimates.resize(settings.m_imageWidth * settings.m_imageHeight);
+	PCG32 random(3, 4);
+	for (PixelEstimate &estimate : written.m_estimates)
+	{
+		int samples = 1 + (int)(random.Next() % 8);
+		for (int s = 0; s < samples; ++s)
+		{
+			estimate.Add(glm::vec3(random.NextFloat(), random.NextFloat(), random.NextFloat()));
+		}
+		estimate.m_squaredError = random.NextFloat();
+	}
+	written.m_estimates[4].Converge();
+
+	Checkpoint read;
+	bool same = written.Write(_path) && read.Read(_path) && read.Matches(settings) && read.m_endSample == written.m_endSample &&
+		read.m_tilesDone == written.m_tilesDone && read.m_estimates.size() == written.m_estimates.size() &&
+		std::memcmp(read.m_estimates.data(), written.m_estimates.data(), written.m_estimates.size() * sizeof(PixelEstimate)) == 0;
+	Report(_results, same, "checkpoint reads back as it was written");
+
+	//Everything but the last estimate
+	std::ifstream ifs(_path.c_str(), std::ios::in | std::ios::binary);
+	std::string bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+	ifs.close();
+	Checkpoint truncated;
+	Report(_results, WriteText(_path, bytes.substr(0, bytes.size() - sizeof(PixelEstimate))) && !truncated.Read(_path), "truncated checkpoint is refused");
+
+	//Whole files whose header would pass Matches()
+	Checkpoint fewerTiles = written;
+	fewerTiles.m_tilesDone.pop_back();
+	Checkpoint noPass = written;
+	noPass.m_endSample = 0;
+	Checkpoint pastLastSample = written;
+	pastLastSample.m_endSample = settings.m_samplesPerPixel + 1;
+	Report(_results, fewerTiles.Write(_path) && !Checkpoint().Read(_path), "checkpoint with a tile flag missing is refused");
+	Report(_results, noPass.Write(_path) && !Checkpoint().Read(_path), "checkpoint with no pass in progress is refused");
+	Report(_results, pastLastSample.Write(_path) && !Checkpoint().Read(_path), "checkpoint with a pass past --spp is refused");
+	std::remove(_path.c_str());
+}
+
+//Scene files that must each be refused with a message rather than loaded or crashed on
+static void CheckSceneFiles(SelfTestResults &_results, const std::string &_path)
+{
+	const char *damaged[][2] = {
+		{ "unknown material", "material red 1 0 0\nsphere blue 0 0 0 1\n" },
+		{ "material missing a colour", "material red 1 0\n" },
+		{ "light with a word for a number", "light 1 2 x\n" },
+		{ "refractive index of zero", "material glass 0 0 0  1 1 1  1  0  1 0\n" },
+		{ "vertex before any mesh", "v 0 0 0\n" },
+		{ "face of a missing vertex", "material red 1 0 0\nmesh red\nv 0 0 0\nv 1 0 0\nf 1 2 3\n" },
+		{ "unknown statement", "material red 1 0 0\ncube red 0 0 0 1\n" }
+	};
+	for (const auto &scene : damaged)
+	{
+		SceneDescription description;
+		std::remove((_path + ".cache").c_str());
+		Report(_results, WriteText(_path, scene[1]) && !LoadSceneFile(_path, description), std::string("scene file with a ") + scene[0] + " is refused");
+	}
+	std::remove(_path.c_str());
+	std::remove((_path + ".cache").c_str());
+}
+
+//A geometry file laid out as WriteGeometryFile lays it out, with whatever nodes it is given
+static bool WriteRawGeometry(const std::string &_path, const std::vector<BVHNode> &_nodes)
+{
+	const glm::vec3 vertices[3] = { glm::vec3(0, 0, 0), glm::vec3(1, 0, 0), glm::vec3(0, 1, 0) };
+	const unsigned int indices[3] = { 0, 1, 2 };
+
+	GeometrySection sections[3];
+	sections[0].m_type = geometryVertices;
+	sections[0].m_elementSize = sizeof(glm::vec3);
+	sections[0].m_count = 3;
+	sections[1].m_type = geometryIndices;
+	sections[1].m_elementSize = sizeof(unsigned int);
+	sections[1].m_count = 3;
+	sections[2].m_type = geometryNodes;
+	sections[2].m_elementSize = sizeof(BVHNode);
+	sections[2].m_count = _nodes.size();
+	const void *data[3] = { vertices, indices, _nodes.data() };
+
+	GeometryHeader header;
+	std::memcpy(header.m_magic, geometryFileMagic, sizeof(header.m_magic));
+	header.m_version = geometryFileVersion;
+	header.m_byteOrder = geometryFileByteOrder;
+	header.m_numberOfSections = 3;
+	header.m_reserved = 0;
+
+	std::string bytes((const char *)&header, sizeof(header));
+	bytes.append((const char *)sections, sizeof(sections));
+	for (int s = 0; s < 3; ++s)
+	{
+		sections[s].m_offset = (bytes.size() + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+		bytes.resize((size_t)sections[s].m_offset, '\0');
+		bytes.append((const char *)data[s], (size_t)(sections[s].m_elementSize * sections[s].m_count));
+	}
+	std::memcpy(&bytes[sizeof(header)], sections, sizeof(sections));
+	return WriteText(_path, bytes);
+}
+
+//A node whose two children are _left and the node after it
+static BVHNode Interior(int _left)
+{
+	BVHNode node;
+	node.m_bounds = AABB(glm::vec3(-1, -1, -1), glm::vec3(2, 2, 2));
+	node.m_leftOrFirst = _left;
+	node.m_count = 0;
+	return node;
+}
+
+static void CheckGeometryFiles(SelfTestResults &_results, const std::string &_path)
+{
+	//A file written here maps, and is unmapped again before the file is overwritten
+	std::vector<glm::vec3> vertices = { glm::vec3(0, 0, 0), glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(1, 1, 0) };
+	std::vector<unsigned int> indices = { 0, 1, 2, 2, 1, 3 };
+	{
+		MappedMesh written(0);
+		Report(_results, WriteGeometryFile(_path, vertices, indices) && written.Open(_path) && written.NumberOfTriangles() == 2, "geometry file maps as it was written");
+	}
+
+	Report(_results, WriteText(_path, "v 0 0 0\n") && !MappedMesh(0).Open(_path), "text file is refused as a geometry file");
+
+	//A leaf past the one triangle there is
+	BVHNode leaf;
+	leaf.m_bounds = AABB(glm::vec3(0, 0, 0), glm::vec3(1, 1, 0));
+	leaf.m_leftOrFirst = 0;
+	leaf.m_count = 1;
+	std::vector<BVHNode> nodes = { Interior(1), leaf, leaf };
+	nodes[2].m_leftOrFirst = 1;
+	Report(_results, WriteRawGeometry(_path, nodes) && !MappedMesh(0).Open(_path), "geometry file with a leaf outside its triangles is refused");
+
+	//A child before its parent would let traversal loop
+	nodes = { Interior(1), Interior(0), leaf, leaf };
+	Report(_results, WriteRawGeometry(_path, nodes) && !MappedMesh(0).Open(_path), "geometry file with a cycle in its BVH is refused");
+
+	//The root's left child starts a chain down to bvhMaxDepth, its right child leads straight to the bottom of the chain,
+	//so the bottom is reached shallow and deep, and the chain goes on below it
+	nodes.assign(2 * bvhMaxDepth + 30, leaf);
+	nodes[0] = Interior(1);
+	int deepest = 1;
+	for (int depth = 1; depth < bvhMaxDepth - 1; ++depth)
+	{
+		nodes[deepest] = Interior(deepest + 2);
+		deepest += 2;
+	}
+	int shared = deepest + 4;
+	nodes[deepest] = Interior(shared);
+	nodes[2] = Interior(deepest + 2);
+	nodes[deepest + 2] = Interior(shared);
+	for (int k = shared; k < shared + 20; k += 2)
+	{
+		nodes[k] = Interior(k + 2);
+	}
+	Report(_results, WriteRawGeometry(_path, nodes) && !MappedMesh(0).Open(_path), "geometry file with a BVH deeper than the traversal stack is refused");
+
+	//Cut short in the middle of the nodes
+	std::vector<BVHNode> valid = { Interior(1), leaf, leaf };
+	std::ifstream ifs;
+	bool truncated = WriteRawGeometry(_path, valid);
+	ifs.open(_path.c_str(), std::ios::in | std::ios::binary);
+	std::string bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+	ifs.close();
+	truncated = truncated && MappedMesh(0).Open(_path) && WriteText(_path, bytes.substr(0, bytes.size() - sizeof(BVHNode)));
+	Report(_results, truncated && !MappedMesh(0).Open(_path), "truncated geometry file is refused");
+	std::remove(_path.c_str());
+}
+
+//Mirror, glass, a mesh and two lights, so every integrator has bounces and shadow rays to trace
+static const char *selfTestScene =
+	"camera 0 2 10  0 0 -20  60\n"
+	"light 20 20 0  1 1 1\n"
+	"light -10 10 5  0.4 0.4 0.5\n"
+	"material grey 0.35 0.35 0.35  0.2 0.2 0.2  0\n"
+	"material red 1 0.35 0.35  0.65 0.65 0.76  128\n"
+	"material mirror 0.1 0.1 0.1  0.9 0.9 0.9  128  0.8\n"
+	"material glass 0.1 0.1 0.1  1 1 1  128  0  1 1.5\n"
+	"plane grey 0 -5 0  0 1 0\n"
+	"sphere red -8 0 -20 4\n"
+	"sphere mirror 3 0 -22 3\n"
+	"sphere glass 0 -2 -12 2\n"
+	"mesh red\n"
+	"v 6 -5 -15\n"
+	"v 12 -5 -15\n"
+	"v 9 1 -17\n"
+	"f 1 2 3\n";
+
+//The image _settings plus _options gives, false if the scene couldn't be loaded
+static bool RenderImage(const RenderSettings &_settings, const std::vector<std::string> &_options, Framebuffer *_image)
+{
+	Renderer renderer;
+	renderer.m_settings = _settings;
+	if (!renderer.m_settings.ParseOptions(_options))
+	{
+		return false;
+	}
+	TaskScheduler scheduler(renderer.m_settings.m_numberOfThreads);
+	if (!renderer.LoadScene(renderer.m_settings.m_scene, scheduler))
+	{
+		return false;
+	}
+	renderer.Render(scheduler);
+	_image->CopyFrom(renderer.m_image);
+	return true;
+}
+
+//Every channel within _tolerance of the larger of the two, relative, 0 asks for the same floats
+static bool SameImage(const Framebuffer &_a, const Framebuffer &_b, float _tolerance = 0.0f)
+{
+	if (_a.Width() != _b.Width() || _a.Height() != _b.Height())
+	{
+		return false;
+	}
+	for (int y = 0; y < _a.Height(); ++y)
+	{
+		for (int x = 0; x < _a.Width(); ++x)
+		{
+			glm::vec3 a = _a.Pixel(x, y);
+			glm::vec3 b = _b.Pixel(x, y);
+			glm::vec3 allowed = _tolerance * glm::max(glm::abs(a), glm::abs(b));
+			if (!glm::all(glm::lessThanEqual(glm::abs(a - b), allowed)))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//A way of tracing to compare with one thread tracing single rays
+struct ImageVariant
+{
+	std::string m_name;
+	std::vector<std::string> m_options;
+	std::vector<std::string> m_reference;	//Given to the reference render too, for options that change which samples are taken
+	float m_whittedTolerance;				//See SameImage, for whitted shading summed in another order
+};
+
+//Each way of tracing takes the same samples, so it must give the same floats as one thread tracing single rays
+static void CheckImages(SelfTestResults &_results, const std::vector<std::string> &_scenes, const std::vector<ImageVariant> &_variants)
+{
+	const char *integrators[] = { "whitted", "path" };
+	for (const std::string &scene : _scenes)
+	{
+		for (const char *integrator : integrators)
+		{
+			RenderSettings settings;
+			settings.m_scene = scene;
+			std::vector<std::string> base = { "--width", "48", "--height", "36", "--spp", "4", "--depth", "3", "--integrator", integrator, "--threads", "1" };
+
+			for (const ImageVariant &variant : _variants)
+			{
+				std::vector<std::string> reference = base;
+				reference.push_back("--no-packets");
+				reference.insert(reference.end(), variant.m_reference.begin(), variant.m_reference.end());
+				std::vector<std::string> options = base;
+				options.insert(options.end(), variant.m_reference.begin(), variant.m_reference.end());
+				options.insert(options.end(), variant.m_options.begin(), variant.m_options.end());
+
+				Framebuffer expected;
+				Framebuffer image;
+				Report(_results, RenderImage(settings, reference, &expected) && RenderImage(settings, options, &image) && SameImage(image, expected, std::strcmp(integrator, "whitted") == 0 ? variant.m_whittedTolerance : 0.0f),
+					scene + " " + integrator + " " + variant.m_name + " matches single rays on one thread");
+			}
+		}
+	}
+}
+
+//--no-shadows is a whitted preview shortcut, a path traced light sample always tests for occluders
+static void CheckPathShadows(SelfTestResults &_results, const std::string &_scene)
+{
+	RenderSettings settings;
+	settings.m_scene = _scene;
+	std::vector<std::string> options = { "--width", "48", "--height", "36", "--spp", "4", "--integrator", "path", "--threads", "1" };
+	Framebuffer shadowed;
+	Framebuffer image;
+	bool same = RenderImage(settings, options, &shadowed);
+	options.push_back("--no-shadows");
+	same = same && RenderImage(settings, options, &image) && SameImage(image, shadowed);
+	Report(_results, same, _scene + " path --no-shadows still tests light samples for occluders");
+}
+
+//The self-test scene with its mesh mapped from a geometry file instead, the triangle test is the same so the image must be
+static void CheckMappedMesh(SelfTestResults &_results, const std::string &_sceneFile, const std::string &_path)
+{
+	const std::string inlineMesh = "mesh red\nv 6 -5 -15\nv 12 -5 -15\nv 9 1 -17\nf 1 2 3\n";
+	const std::vector<glm::vec3> vertices = { glm::vec3(6, -5, -15), glm::vec3(12, -5, -15), glm::vec3(9, 1, -17) };
+	const std::vector<unsigned int> indices = { 0, 1, 2 };
+	std::string mappedScene = selfTestScene;
+	mappedScene.replace(mappedScene.find(inlineMesh), inlineMesh.size(), "geometry red " + _path + ".geo\n");
+
+	RenderSettings inlineSettings;
+	inlineSettings.m_scene = _sceneFile;
+	RenderSettings mappedSettings;
+	mappedSettings.m_scene = _path;
+	const std::vector<std::string> options = { "--width", "48", "--height", "36", "--spp", "4", "--threads", "1" };
+	Framebuffer inlineImage;
+	Framebuffer mappedImage;
+	Report(_results, WriteGeometryFile(_path + ".geo", vertices, indices) && WriteText(_path, mappedScene) && RenderImage(inlineSettings, options, &inlineImage) &&
+		RenderImage(mappedSettings, options, &mappedImage) && SameImage(inlineImage, mappedImage), _sceneFile + " renders the same with its mesh in a geometry file");
+	std::remove(_path.c_str());
+	std::remove((_path + ".cache").c_str());
+	std::remove((_path + ".geo").c_str());
+}
+
+int RunSelfTest(const RenderSettings &_settings)
+{
+	SelfTestResults results;
+	results.m_checks = 0;
+	results.m_failures = 0;
+
+	//Several workers even on one core, so the tasks still interleave
+	int numberOfThreads = std::max(_settings.m_numberOfThreads, 4);
+	std::string threads = std::to_string(numberOfThreads);
+
+	std::cout << "Options (each refusal prints its message):" << std::endl;
+	CheckOptions(results);
+
+	std::cout << "Acceleration structures:" << std::endl;
+	{
+		TaskScheduler scheduler(numberOfThreads);
+		CheckParallelBuild(results, scheduler);
+	}
+	CheckTraversals(results);
+
+	std::cout << "Input files (each refusal prints its message):" << std::endl;
+	std::string base = _settings.m_output + ".selftest";
+	CheckCheckpoint(results, base + ".checkpoint");
+	CheckSceneFiles(results, base + ".scene");
+	CheckGeometryFiles(results, base + ".geo");
+
+	std::cout << "Images:" << std::endl;
+	std::vector<std::string> scenes = { "default", "particles:2000" };
+	std::vector<ImageVariant> variants = {
+		{ threads + " threads stealing tiles", { "--no-packets", "--threads", threads }, {}, 0.0f },
+		{ "4x4 packets", {}, {}, 0.0f },
+		{ "adaptive sampling on " + threads + " threads", { "--threads", threads }, { "--adaptive", "0.01", "--min-spp", "2" }, 0.0f },
+		{ "progressive passes", { "--progressive" }, {}, 0.0f },
+		//Whitted shading in a wavefront adds each light's term to the pixel on its own rather than summed per surface
+		//first, so its floats may round a step differently
+		{ "wavefront", { "--wavefront" }, {}, 1e-5f },
+		{ "adaptive wavefront on " + threads + " threads", { "--threads", threads, "--wavefront" }, { "--adaptive", "0.01", "--min-spp", "2" }, 1e-5f },
+		{ "wavefront with sorted rays", { "--sort-rays" }, {}, 1e-5f },
+		{ "compact BVH", { "--compact-bvh" }, {}, 0.0f }
+	};
+	std::string sceneFile = base + ".scene";
+	if (WriteText(sceneFile, selfTestScene))
+	{
+		//Parsed the first time, read back from its cache the second
+		std::remove((sceneFile + ".cache").c_str());
+		RenderSettings settings;
+		settings.m_scene = sceneFile;
+		const std::vector<std::string> options = { "--width", "48", "--height", "36", "--threads", "1" };
+		Framebuffer parsed;
+		Framebuffer cached;
+		Report(results, RenderImage(settings, options, &parsed) && RenderImage(settings, options, &cached) && SameImage(parsed, cached),
+			sceneFile + " renders the same from its cache as parsed");
+		CheckMappedMesh(results, sceneFile, base + ".mapped.scene");
+		scenes.push_back(sceneFile);
+	}
+	else
+	{
+		Report(results, false, "write " + sceneFile);
+	}
+	CheckImages(results, scenes, variants);
+	CheckPathShadows(results, scenes.back());
+	std::remove(sceneFile.c_str());
+	std::remove((sceneFile + ".cache").c_str());
+
+	std::cout << "\n " << results.m_checks - results.m_failures << " of " << results.m_checks << " checks passed" << std::endl;
+	return results.m_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+/// \file SelfTest.h
+/// \brief checks that the faster paths give the same trees, hits and images as the ones they replaced, and that damaged files are refused
+/// \author Josh Bailey
+
+#ifndef _SELFTEST_H_
+#define _SELFTEST_H_
+
+//File includes
+#include "RenderSettings.h"
+
+//Temporary files go beside _settings.m_output and are removed afterwards, returns the process exit code, 0 if every check passed
+int RunSelfTest(const RenderSettings &_settings);
+
+#endif // _SELFTEST_H_
\ No newline at end of file
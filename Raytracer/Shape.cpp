@@ -9,24 +9,19 @@ Shape::Shape()
 {
 	//Shape defaults
 	m_position = glm::vec3(0, 0, 0);
-	m_colour = glm::vec3(0, 0, 0);
 	m_normal = glm::vec3(0, 0, 0);
+	m_material = 0;
 }
 
-Shape::Shape(glm::vec3 _position, glm::vec3 _colour, glm::vec3 _normal)
+Shape::Shape(glm::vec3 _position, int _material, glm::vec3 _normal)
 {
 	//Create shape with specific parameters
 	m_position = _position;
-	m_colour = _colour;
 	m_normal = _normal;
+	m_material = _material;
 }
 
-bool Shape::Intersection(float *_t, glm::vec3 _originOfRay, glm::vec3 _directionOfRay)
+void Shape::Flatten(FlatScene *)
 {
-	return false;
-}
-
-glm::vec3 Shape::NormalCalculation(glm::vec3 _p0, int *_shine, glm::vec3* _colourOfDiffuse, glm::vec3 *_colourOfSpecular)
-{
-	return m_normal;
+	//Nothing to render
 }
\ No newline at end of file
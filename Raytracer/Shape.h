@@ -8,20 +8,21 @@
 //File includes
 #include <glm.hpp>
 
+class FlatScene;
+
 class Shape
 {
 public:
 	//Variables
 	glm::vec3 m_position;
-	glm::vec3 m_colour;
 	glm::vec3 m_normal;
+	int m_material;		//Index into the scene's list of materials
 
 	//Functions
 	Shape();
-	Shape(glm::vec3 _position, glm::vec3 _colour, glm::vec3 _normal);
+	Shape(glm::vec3 _position, int _material, glm::vec3 _normal);
 	//"Virtual" in order for method to be inherited
-	virtual bool Intersection(float *_t, glm::vec3 _originOfRay, glm::vec3 _directionOfRay);
-	virtual glm::vec3 NormalCalculation(glm::vec3 _p0, int *_shine, glm::vec3* _colourOfDiffuse, glm::vec3 *_colourOfSpecular);
+	virtual void Flatten(FlatScene *_scene);	//Adds the primitives this shape is made of, rendering only sees those
 };
 
 #endif // _SHAPE_H_
\ No newline at end of file
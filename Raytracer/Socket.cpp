@@ -0,0 +1,238 @@
+/// @file Socket.cpp
+/// @brief Thin wrapper over the platform socket calls, Winsock is started the first time a socket is made
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+typedef int socklen_t;
+#define SOCKET_CLOSE closesocket
+#define SOCKET_SHUTDOWN_BOTH SD_BOTH
+#define SOCKET_NO_SIGNAL 0
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define SOCKET_CLOSE close
+#define SOCKET_SHUTDOWN_BOTH SHUT_RDWR
+#ifdef MSG_NOSIGNAL
+#define SOCKET_NO_SIGNAL MSG_NOSIGNAL	//A worker that has gone away is an error to return, not a SIGPIPE
+#else
+#define SOCKET_NO_SIGNAL 0
+#endif
+#endif
+
+#include <cstring>
+#include <string>
+
+#include "Socket.h"
+
+#ifdef _WIN32
+typedef SOCKET NativeSocket;
+static const NativeSocket invalidSocket = INVALID_SOCKET;
+
+//Winsock has to be started before anything else, once per process
+static bool StartSockets()
+{
+	static bool started = false;
+	if (!started)
+	{
+		WSADATA data;
+		started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}
+	return started;
+}
+#else
+typedef int NativeSocket;
+static const NativeSocket invalidSocket = -1;
+
+static bool StartSockets()
+{
+	return true;
+}
+#endif
+
+//Small messages go out as soon as they are sent, tile requests would otherwise wait on Nagle's algorithm
+static void DisableDelay(NativeSocket _handle)
+{
+	int enable = 1;
+	setsockopt(_handle, IPPROTO_TCP, TCP_NODELAY, (const char *)&enable, sizeof(enable));
+}
+
+Socket::Socket()
+{
+	m_handle = (long long)invalidSocket;
+}
+
+Socket::~Socket()
+{
+	Close();
+}
+
+Socket::Socket(Socket &&_other)
+{
+	m_handle = _other.m_handle;
+	_other.m_handle = (long long)invalidSocket;
+}
+
+Socket &Socket::operator=(Socket &&_other)
+{
+	if (this != &_other)
+	{
+		Close();
+		m_handle = _other.m_handle;
+		_other.m_handle = (long long)invalidSocket;
+	}
+	return *this;
+}
+
+bool Socket::Listen(int _port)
+{
+	Close();
+	if (!StartSockets())
+	{
+		return false;
+	}
+
+	NativeSocket handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (handle == invalidSocket)
+	{
+		return false;
+	}
+	m_handle = (long long)handle;
+
+	//A coordinator restarted straight away can take its port back
+	int enable = 1;
+	setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, (const char *)&enable, sizeof(enable));
+
+	sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons((unsigned short)_port);
+	if (bind(handle, (const sockaddr *)&address, sizeof(address)) != 0 || listen(handle, SOMAXCONN) != 0)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool Socket::WaitForConnection(int _milliseconds) const
+{
+	NativeSocket handle = (NativeSocket)m_handle;
+	fd_set readable;
+	FD_ZERO(&readable);
+	FD_SET(handle, &readable);
+	timeval timeout;
+	timeout.tv_sec = _milliseconds / 1000;
+	timeout.tv_usec = (_milliseconds % 1000) * 1000;
+	return select((int)handle + 1, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+Socket Socket::Accept()
+{
+	Socket connection;
+	NativeSocket handle = accept((NativeSocket)m_handle, nullptr, nullptr);
+	if (handle != invalidSocket)
+	{
+		DisableDelay(handle);
+		connection.m_handle = (long long)handle;
+	}
+	return connection;
+}
+
+bool Socket::Connect(const std::string &_host, int _port)
+{
+	Close();
+	if (!StartSockets())
+	{
+		return false;
+	}
+
+	addrinfo hints;
+	std::memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo *addresses = nullptr;
+	if (getaddrinfo(_host.c_str(), std::to_string(_port).c_str(), &hints, &addresses) != 0)
+	{
+		return false;
+	}
+
+	//First address that accepts the connection
+	for (addrinfo *address = addresses; address != nullptr; address = address->ai_next)
+	{
+		NativeSocket handle = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if (handle == invalidSocket)
+		{
+			continue;
+		}
+		if (connect(handle, address->ai_addr, (socklen_t)address->ai_addrlen) == 0)
+		{
+			DisableDelay(handle);
+			m_handle = (long long)handle;
+			break;
+		}
+		SOCKET_CLOSE(handle);
+	}
+	freeaddrinfo(addresses);
+	return Valid();
+}
+
+bool Socket::Send(const void *_data, size_t _size)
+{
+	const char *data = (const char *)_data;
+	while (_size > 0)
+	{
+		int sent = (int)send((NativeSocket)m_handle, data, (int)_size, SOCKET_NO_SIGNAL);
+		if (sent <= 0)
+		{
+			return false;
+		}
+		data += sent;
+		_size -= sent;
+	}
+	return true;
+}
+
+bool Socket::Receive(void *_data, size_t _size)
+{
+	char *data = (char *)_data;
+	while (_size > 0)
+	{
+		int received = (int)recv((NativeSocket)m_handle, data, (int)_size, 0);
+		if (received <= 0)
+		{
+			return false;
+		}
+		data += received;
+		_size -= received;
+	}
+	return true;
+}
+
+void Socket::Shutdown()
+{
+	if (Valid())
+	{
+		shutdown((NativeSocket)m_handle, SOCKET_SHUTDOWN_BOTH);
+	}
+}
+
+void Socket::Close()
+{
+	if (Valid())
+	{
+		SOCKET_CLOSE((NativeSocket)m_handle);
+		m_handle = (long long)invalidSocket;
+	}
+}
+
+bool Socket::Valid() const
+{
+	return m_handle != (long long)invalidSocket;
+}
\ No newline at end of file
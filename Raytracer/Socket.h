@@ -0,0 +1,39 @@
+/// \file Socket.h
+/// \brief blocking TCP connection, just enough for the tile coordinator and its workers, on Winsock or BSD sockets
+/// \author Josh Bailey
+
+#ifndef _SOCKET_H_
+#define _SOCKET_H_
+
+//File includes
+#include <cstddef>
+#include <string>
+
+class Socket
+{
+public:
+	//Functions
+	Socket();
+	~Socket();
+	Socket(Socket &&_other);
+	Socket &operator=(Socket &&_other);
+	bool Listen(int _port);										//Any interface
+	bool WaitForConnection(int _milliseconds) const;			//True if Accept() won't block
+	Socket Accept();
+	bool Connect(const std::string &_host, int _port);
+	bool Send(const void *_data, size_t _size);					//Everything or false
+	bool Receive(void *_data, size_t _size);					//Everything or false, false when the other end has gone
+	void Shutdown();											//Wakes a thread blocked in Receive() on this socket
+	void Close();
+	bool Valid() const;
+
+private:
+	//Variables
+	long long m_handle;		//SOCKET on Windows, file descriptor elsewhere, -1 when closed
+
+	//Non-copyable, owns its connection
+	Socket(const Socket &);
+	Socket &operator=(const Socket &);
+};
+
+#endif // _SOCKET_H_
\ No newline at end of file
@@ -19,9 +19,8 @@ public:
 
 	//Functions
 	Sphere();
-	Sphere(glm::vec3 _position, float _radius, glm::vec3 _colour);
-	bool Intersection(float *_t, glm::vec3 _OriginOfRay, glm::vec3 _directionOfRay);
-	glm::vec3 NormalCalculation(glm::vec3 _p0, int *_shine, glm::vec3* _colourOfDiffuse, glm::vec3 *_colourOfSpecular);
+	Sphere(glm::vec3 _position, float _radius, int _material);
+	void Flatten(FlatScene *_scene);
 };
 
 #endif // _SPHERE_H_
\ No newline at end of file
@@ -0,0 +1,309 @@
+/// @file SphereSet.cpp
+/// @brief Packs spheres into aligned arrays and intersects one ray against 4 (SSE) or 8 (AVX) of them at once
+
+#include <cmath>
+
+#include "AlignedMemory.h"
+#include "SphereSet.h"
+
+#if defined(SPHERESET_AVX)
+#include <immintrin.h>
+#elif defined(SPHERESET_SSE)
+#include <emmintrin.h>
+#endif
+
+SphereSet::SphereSet()
+{
+	m_centreX = nullptr;
+	m_centreY = nullptr;
+	m_centreZ = nullptr;
+	m_radiusSquared = nullptr;
+	m_material = nullptr;
+	m_count = 0;
+}
+
+SphereSet::~SphereSet()
+{
+	Free();
+}
+
+void SphereSet::Free()
+{
+	AlignedFree(m_centreX);
+	AlignedFree(m_centreY);
+	AlignedFree(m_centreZ);
+	AlignedFree(m_radiusSquared);
+	AlignedFree(m_material);
+	m_centreX = nullptr;
+	m_centreY = nullptr;
+	m_centreZ = nullptr;
+	m_radiusSquared = nullptr;
+	m_material = nullptr;
+	m_count = 0;
+}
+
+void SphereSet::Resize(int _count)
+{
+	Free();
+
+	//An extra SIMD width on the end so a load starting at the last sphere never reads past the allocation
+	int padded = ((_count + SPHERESET_WIDTH - 1) / SPHERESET_WIDTH + 1) * SPHERESET_WIDTH;
+	m_centreX = (float *)AlignedAllocate(padded * sizeof(float));
+	m_centreY = (float *)AlignedAllocate(padded * sizeof(float));
+	m_centreZ = (float *)AlignedAllocate(padded * sizeof(float));
+	m_radiusSquared = (float *)AlignedAllocate(padded * sizeof(float));
+	m_material = (int *)AlignedAllocate(padded * sizeof(int));
+	m_count = _count;
+
+	for (int i = 0; i < padded; ++i)
+	{
+		SetEmpty(i);
+	}
+}
+
+void SphereSet::Set(int _slot, const glm::vec3 &_centre, float _radius, int _material)
+{
+	m_centreX[_slot] = _centre.x;
+	m_centreY[_slot] = _centre.y;
+	m_centreZ[_slot] = _centre.z;
+	m_radiusSquared[_slot] = _radius * _radius;
+	m_material[_slot] = _material;
+}
+
+void SphereSet::SetEmpty(int _slot)
+{
+	m_centreX[_slot] = 0.0f;
+	m_centreY[_slot] = 0.0f;
+	m_centreZ[_slot] = 0.0f;
+	m_radiusSquared[_slot] = -INFINITY;
+	m_material[_slot] = -1;
+}
+
+bool SphereSet::Intersection(float *_t, int *_slot, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, int _first, int _count, float _maxT) const
+{
+	//Sphere intersection method - https://www.scratchapixel.com/lessons/3d-basic-rendering/minimal-ray-tracer-rendering-simple-shapes/ray-sphere-intersection
+	//comparing squared distances so the early outs need no square root, a ray starting inside a sphere (refraction)
+	//takes the far root as the near one is behind it
+	float bestT = _maxT;
+	int bestSlot = -1;
+	int end = _first + _count;
+
+#if defined(SPHERESET_AVX)
+	const __m256 originX = _mm256_set1_ps(_originOfRay.x);
+	const __m256 originY = _mm256_set1_ps(_originOfRay.y);
+	const __m256 originZ = _mm256_set1_ps(_originOfRay.z);
+	const __m256 directionX = _mm256_set1_ps(_directionOfRay.x);
+	const __m256 directionY = _mm256_set1_ps(_directionOfRay.y);
+	const __m256 directionZ = _mm256_set1_ps(_directionOfRay.z);
+	const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256 zero = _mm256_setzero_ps();
+
+	for (int slot = _first; slot < end; slot += 8)
+	{
+		__m256 lx = _mm256_sub_ps(_mm256_loadu_ps(m_centreX + slot), originX);
+		__m256 ly = _mm256_sub_ps(_mm256_loadu_ps(m_centreY + slot), originY);
+		__m256 lz = _mm256_sub_ps(_mm256_loadu_ps(m_centreZ + slot), originZ);
+		__m256 radiusSquared = _mm256_loadu_ps(m_radiusSquared + slot);
+
+		__m256 tca = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(lx, directionX), _mm256_mul_ps(ly, directionY)), _mm256_mul_ps(lz, directionZ));
+		__m256 lengthSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(lx, lx), _mm256_mul_ps(ly, ly)), _mm256_mul_ps(lz, lz));
+		__m256 s2 = _mm256_sub_ps(lengthSquared, _mm256_mul_ps(tca, tca));
+		__m256 thc = _mm256_sqrt_ps(_mm256_sub_ps(radiusSquared, s2));
+		__m256 t = _mm256_sub_ps(tca, thc);
+		t = _mm256_blendv_ps(t, _mm256_add_ps(tca, thc), _mm256_cmp_ps(t, zero, _CMP_LT_OQ));	//From inside, the far side
+
+		//Lanes past the end of the range belong to someone else
+		__m256 hit = _mm256_cmp_ps(lane, _mm256_set1_ps((float)(end - slot)), _CMP_LT_OQ);
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(s2, radiusSquared, _CMP_LE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, _mm256_set1_ps(bestT), _CMP_LT_OQ));
+
+		int mask = _mm256_movemask_ps(hit);
+		if (mask != 0)
+		{
+			alignas(32) float lanes[8];
+			_mm256_store_ps(lanes, t);
+			for (int i = 0; i < 8; ++i)
+			{
+				if ((mask >> i) & 1 && lanes[i] < bestT)
+				{
+					bestT = lanes[i];
+					bestSlot = slot + i;
+				}
+			}
+		}
+	}
+#elif defined(SPHERESET_SSE)
+	const __m128 originX = _mm_set1_ps(_originOfRay.x);
+	const __m128 originY = _mm_set1_ps(_originOfRay.y);
+	const __m128 originZ = _mm_set1_ps(_originOfRay.z);
+	const __m128 directionX = _mm_set1_ps(_directionOfRay.x);
+	const __m128 directionY = _mm_set1_ps(_directionOfRay.y);
+	const __m128 directionZ = _mm_set1_ps(_directionOfRay.z);
+	const __m128 lane = _mm_setr_ps(0, 1, 2, 3);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int slot = _first; slot < end; slot += 4)
+	{
+		__m128 lx = _mm_sub_ps(_mm_loadu_ps(m_centreX + slot), originX);
+		__m128 ly = _mm_sub_ps(_mm_loadu_ps(m_centreY + slot), originY);
+		__m128 lz = _mm_sub_ps(_mm_loadu_ps(m_centreZ + slot), originZ);
+		__m128 radiusSquared = _mm_loadu_ps(m_radiusSquared + slot);
+
+		__m128 tca = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, directionX), _mm_mul_ps(ly, directionY)), _mm_mul_ps(lz, directionZ));
+		__m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, lx), _mm_mul_ps(ly, ly)), _mm_mul_ps(lz, lz));
+		__m128 s2 = _mm_sub_ps(lengthSquared, _mm_mul_ps(tca, tca));
+		__m128 thc = _mm_sqrt_ps(_mm_sub_ps(radiusSquared, s2));
+		__m128 t = _mm_sub_ps(tca, thc);
+		__m128 inside = _mm_cmplt_ps(t, zero);
+		t = _mm_or_ps(_mm_and_ps(inside, _mm_add_ps(tca, thc)), _mm_andnot_ps(inside, t));	//From inside, the far side
+
+		//Lanes past the end of the range belong to someone else
+		__m128 hit = _mm_cmplt_ps(lane, _mm_set1_ps((float)(end - slot)));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(t, zero));
+		hit = _mm_and_ps(hit, _mm_cmple_ps(s2, radiusSquared));
+		hit = _mm_and_ps(hit, _mm_cmplt_ps(t, _mm_set1_ps(bestT)));
+
+		int mask = _mm_movemask_ps(hit);
+		if (mask != 0)
+		{
+			alignas(16) float lanes[4];
+			_mm_store_ps(lanes, t);
+			for (int i = 0; i < 4; ++i)
+			{
+				if ((mask >> i) & 1 && lanes[i] < bestT)
+				{
+					bestT = lanes[i];
+					bestSlot = slot + i;
+				}
+			}
+		}
+	}
+#else
+	for (int slot = _first; slot < end; ++slot)
+	{
+		glm::vec3 L = glm::vec3(m_centreX[slot], m_centreY[slot], m_centreZ[slot]) - _originOfRay;
+		float tca = glm::dot(L, _directionOfRay);
+		float s2 = glm::dot(L, L) - (tca * tca);
+		if (s2 <= m_radiusSquared[slot])
+		{
+			float thc = glm::sqrt(m_radiusSquared[slot] - s2);
+			float t = tca - thc;
+			if (t < 0)
+			{
+				t = tca + thc;	//From inside, the far side
+			}
+			if (t >= 0 && t < bestT)
+			{
+				bestT = t;
+				bestSlot = slot;
+			}
+		}
+	}
+#endif
+
+	if (bestSlot == -1)
+	{
+		return false;
+	}
+	*_t = bestT;
+	*_slot = bestSlot;
+	return true;
+}
+
+bool SphereSet::Occluded(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, int _first, int _count, float _maxT) const
+{
+	//Same tests as Intersection, but the first lane that hits ends the search
+	int end = _first + _count;
+
+#if defined(SPHERESET_AVX)
+	const __m256 originX = _mm256_set1_ps(_originOfRay.x);
+	const __m256 originY = _mm256_set1_ps(_originOfRay.y);
+	const __m256 originZ = _mm256_set1_ps(_originOfRay.z);
+	const __m256 directionX = _mm256_set1_ps(_directionOfRay.x);
+	const __m256 directionY = _mm256_set1_ps(_directionOfRay.y);
+	const __m256 directionZ = _mm256_set1_ps(_directionOfRay.z);
+	const __m256 maxT = _mm256_set1_ps(_maxT);
+	const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256 zero = _mm256_setzero_ps();
+
+	for (int slot = _first; slot < end; slot += 8)
+	{
+		__m256 lx = _mm256_sub_ps(_mm256_loadu_ps(m_centreX + slot), originX);
+		__m256 ly = _mm256_sub_ps(_mm256_loadu_ps(m_centreY + slot), originY);
+		__m256 lz = _mm256_sub_ps(_mm256_loadu_ps(m_centreZ + slot), originZ);
+		__m256 radiusSquared = _mm256_loadu_ps(m_radiusSquared + slot);
+
+		__m256 tca = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(lx, directionX), _mm256_mul_ps(ly, directionY)), _mm256_mul_ps(lz, directionZ));
+		__m256 lengthSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(lx, lx), _mm256_mul_ps(ly, ly)), _mm256_mul_ps(lz, lz));
+		__m256 s2 = _mm256_sub_ps(lengthSquared, _mm256_mul_ps(tca, tca));
+		__m256 thc = _mm256_sqrt_ps(_mm256_sub_ps(radiusSquared, s2));
+		__m256 t = _mm256_sub_ps(tca, thc);
+		t = _mm256_blendv_ps(t, _mm256_add_ps(tca, thc), _mm256_cmp_ps(t, zero, _CMP_LT_OQ));
+
+		__m256 hit = _mm256_cmp_ps(lane, _mm256_set1_ps((float)(end - slot)), _CMP_LT_OQ);
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(s2, radiusSquared, _CMP_LE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, maxT, _CMP_LT_OQ));
+
+		if (_mm256_movemask_ps(hit) != 0)
+		{
+			return true;
+		}
+	}
+#elif defined(SPHERESET_SSE)
+	const __m128 originX = _mm_set1_ps(_originOfRay.x);
+	const __m128 originY = _mm_set1_ps(_originOfRay.y);
+	const __m128 originZ = _mm_set1_ps(_originOfRay.z);
+	const __m128 directionX = _mm_set1_ps(_directionOfRay.x);
+	const __m128 directionY = _mm_set1_ps(_directionOfRay.y);
+	const __m128 directionZ = _mm_set1_ps(_directionOfRay.z);
+	const __m128 maxT = _mm_set1_ps(_maxT);
+	const __m128 lane = _mm_setr_ps(0, 1, 2, 3);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int slot = _first; slot < end; slot += 4)
+	{
+		__m128 lx = _mm_sub_ps(_mm_loadu_ps(m_centreX + slot), originX);
+		__m128 ly = _mm_sub_ps(_mm_loadu_ps(m_centreY + slot), originY);
+		__m128 lz = _mm_sub_ps(_mm_loadu_ps(m_centreZ + slot), originZ);
+		__m128 radiusSquared = _mm_loadu_ps(m_radiusSquared + slot);
+
+		__m128 tca = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, directionX), _mm_mul_ps(ly, directionY)), _mm_mul_ps(lz, directionZ));
+		__m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, lx), _mm_mul_ps(ly, ly)), _mm_mul_ps(lz, lz));
+		__m128 s2 = _mm_sub_ps(lengthSquared, _mm_mul_ps(tca, tca));
+		__m128 thc = _mm_sqrt_ps(_mm_sub_ps(radiusSquared, s2));
+		__m128 t = _mm_sub_ps(tca, thc);
+		__m128 inside = _mm_cmplt_ps(t, zero);
+		t = _mm_or_ps(_mm_and_ps(inside, _mm_add_ps(tca, thc)), _mm_andnot_ps(inside, t));
+
+		__m128 hit = _mm_cmplt_ps(lane, _mm_set1_ps((float)(end - slot)));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(t, zero));
+		hit = _mm_and_ps(hit, _mm_cmple_ps(s2, radiusSquared));
+		hit = _mm_and_ps(hit, _mm_cmplt_ps(t, maxT));
+
+		if (_mm_movemask_ps(hit) != 0)
+		{
+			return true;
+		}
+	}
+#else
+	for (int slot = _first; slot < end; ++slot)
+	{
+		glm::vec3 L = glm::vec3(m_centreX[slot], m_centreY[slot], m_centreZ[slot]) - _originOfRay;
+		float tca = glm::dot(L, _directionOfRay);
+		float s2 = glm::dot(L, L) - (tca * tca);
+		if (s2 <= m_radiusSquared[slot])
+		{
+			float thc = glm::sqrt(m_radiusSquared[slot] - s2);
+			float t = tca - thc < 0 ? tca + thc : tca - thc;
+			if (t >= 0 && t < _maxT)
+			{
+				return true;
+			}
+		}
+	}
+#endif
+
+	return false;
+}
\ No newline at end of file
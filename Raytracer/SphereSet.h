@@ -0,0 +1,57 @@
+/// \file SphereSet.h
+/// \brief spheres packed as a structure of arrays, intersected several at a time with SSE/AVX
+/// \author Josh Bailey
+
+#ifndef _SPHERESET_H_
+#define _SPHERESET_H_
+
+//File includes
+#include <glm.hpp>
+
+
+//Number of spheres tested per instruction, picked from the instruction set the compiler is targeting
+#if defined(__AVX__)
+#define SPHERESET_AVX
+#define SPHERESET_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPHERESET_SSE
+#define SPHERESET_WIDTH 4
+#else
+#define SPHERESET_WIDTH 1
+#endif
+
+class SphereSet
+{
+public:
+	//Variables
+	//Each array is cache line aligned and padded to a whole number of SIMD widths,
+	//padding entries have a negative infinite radius squared so can never be hit
+	float *m_centreX;
+	float *m_centreY;
+	float *m_centreZ;
+	float *m_radiusSquared;
+	int *m_material;	//Material of the sphere in each slot, -1 for padding and slots holding other primitives
+	int m_count;
+
+	//Functions
+	SphereSet();
+	~SphereSet();
+	void Resize(int _count);
+	void Set(int _slot, const glm::vec3 &_centre, float _radius, int _material);
+	void SetEmpty(int _slot);
+
+	//Nearest hit closer than _maxT among slots [_first, _first + _count), returns the slot in _slot
+	bool Intersection(float *_t, int *_slot, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, int _first, int _count, float _maxT) const;
+	//Any sphere hit closer than _maxT among slots [_first, _first + _count), returns as soon as one is found
+	bool Occluded(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, int _first, int _count, float _maxT) const;
+
+private:
+	//Non-copyable, owns its arrays
+	SphereSet(const SphereSet &);
+	SphereSet &operator=(const SphereSet &);
+
+	//Functions
+	void Free();
+};
+
+#endif // _SPHERESET_H_
\ No newline at end of file
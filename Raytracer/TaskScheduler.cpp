@@ -0,0 +1,152 @@
+/// @file TaskScheduler.cpp
+/// @brief Work-stealing thread pool, keeps every core busy when some tiles take much longer than others
+
+#include "TaskScheduler.h"
+
+//Which pool the calling thread belongs to, and its index within it
+static thread_local TaskScheduler *currentScheduler = nullptr;
+static thread_local int currentWorker = -1;
+
+TaskScheduler::TaskScheduler(int _numberOfWorkers)
+{
+	if (_numberOfWorkers < 1)
+	{
+		_numberOfWorkers = 1;
+	}
+
+	m_queuedTasks = 0;
+	m_pendingTasks = 0;
+	m_nextQueue = 0;
+	m_running = true;
+
+	//All deques must exist before any worker starts stealing
+	for (int i = 0; i < _numberOfWorkers; ++i)
+	{
+		m_queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue));
+	}
+	for (int i = 0; i < _numberOfWorkers; ++i)
+	{
+		m_workers.push_back(std::thread(&TaskScheduler::WorkerLoop, this, i));
+	}
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepLock);
+		m_running = false;
+	}
+	m_wakeUp.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); ++i)
+	{
+		m_workers[i].join();
+	}
+}
+
+void TaskScheduler::Submit(std::function<void()> _task)
+{
+	++m_pendingTasks;
+
+	//Tasks spawned by a worker stay local to it, anything else is dealt out evenly
+	int queue = (currentScheduler == this) ? currentWorker : (int)(m_nextQueue++ % m_queues.size());
+	{
+		std::lock_guard<std::mutex> lock(m_queues[queue]->m_lock);
+		m_queues[queue]->m_tasks.push_back(std::move(_task));
+	}
+
+	//Taking the sleep lock before notifying stops a worker missing the wake up between checking and sleeping
+	{
+		std::lock_guard<std::mutex> lock(m_sleepLock);
+		++m_queuedTasks;
+	}
+	m_wakeUp.notify_one();
+}
+
+void TaskScheduler::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_sleepLock);
+	m_allDone.wait(lock, [this] { return m_pendingTasks == 0; });
+}
+
+int TaskScheduler::NumberOfWorkers() const
+{
+	return (int)m_workers.size();
+}
+
+int TaskScheduler::DefaultNumberOfWorkers()
+{
+	unsigned cores = std::thread::hardware_concurrency();
+	return cores > 0 ? (int)cores : 1;
+}
+
+int TaskScheduler::CurrentWorker()
+{
+	return currentWorker;
+}
+
+bool TaskScheduler::PopTask(int _worker, std::function<void()> &_task)
+{
+	WorkerQueue &queue = *m_queues[_worker];
+	std::lock_guard<std::mutex> lock(queue.m_lock);
+	if (queue.m_tasks.empty())
+	{
+		return false;
+	}
+	_task = std::move(queue.m_tasks.back());
+	queue.m_tasks.pop_back();
+	return true;
+}
+
+bool TaskScheduler::StealTask(int _thief, std::function<void()> &_task)
+{
+	//Start at the next worker along so thieves don't all pile onto worker 0
+	int numberOfQueues = (int)m_queues.size();
+	for (int i = 1; i < numberOfQueues; ++i)
+	{
+		WorkerQueue &victim = *m_queues[(_thief + i) % numberOfQueues];
+		std::lock_guard<std::mutex> lock(victim.m_lock);
+		if (!victim.m_tasks.empty())
+		{
+			_task = std::move(victim.m_tasks.front());
+			victim.m_tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void TaskScheduler::WorkerLoop(int _worker)
+{
+	currentScheduler = this;
+	currentWorker = _worker;
+
+	std::function<void()> task;
+	while (true)
+	{
+		if (PopTask(_worker, task) || StealTask(_worker, task))
+		{
+			--m_queuedTasks;
+			task();
+			task = nullptr;
+
+			//Last task finished, release anyone in Wait()
+			if (--m_pendingTasks == 0)
+			{
+				std::lock_guard<std::mutex> lock(m_sleepLock);
+				m_allDone.notify_all();
+			}
+			continue;
+		}
+
+		//Nothing to run or steal, sleep until more work is submitted
+		std::unique_lock<std::mutex> lock(m_sleepLock);
+		m_wakeUp.wait(lock, [this] { return !m_running || m_queuedTasks > 0; });
+		if (!m_running && m_queuedTasks == 0)
+		{
+			return;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+/// \file TaskScheduler.h
+/// \brief pool of worker threads, each with its own task deque, that steal work from each other when idle
+/// \author Josh Bailey
+
+#ifndef _TASKSCHEDULER_H_
+#define _TASKSCHEDULER_H_
+
+//File includes
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskScheduler
+{
+public:
+	//Functions
+	TaskScheduler(int _numberOfWorkers);
+	~TaskScheduler();
+	void Submit(std::function<void()> _task);	//Queue a task, workers push onto their own deque, other threads share tasks out round robin
+	void Wait();								//Block until every submitted task (including tasks submitted by tasks) has finished
+	int NumberOfWorkers() const;
+	static int DefaultNumberOfWorkers();		//std::thread::hardware_concurrency(), or 1 if unknown
+	static int CurrentWorker();					//Index of the calling worker thread, -1 if not a worker
+
+private:
+	//Each worker owns a deque, pops from the back (most recent, still in cache), thieves take from the front
+	struct WorkerQueue
+	{
+		std::mutex m_lock;
+		std::deque<std::function<void()>> m_tasks;
+	};
+
+	//Variables
+	std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+	std::vector<std::thread> m_workers;
+	std::atomic<int> m_queuedTasks;		//Tasks sat in a deque waiting to be taken
+	std::atomic<int> m_pendingTasks;	//Tasks submitted but not yet finished
+	std::atomic<unsigned> m_nextQueue;	//Round robin counter for tasks submitted from outside the pool
+	bool m_running;
+	std::mutex m_sleepLock;
+	std::condition_variable m_wakeUp;
+	std::condition_variable m_allDone;
+
+	//Functions
+	bool PopTask(int _worker, std::function<void()> &_task);
+	bool StealTask(int _thief, std::function<void()> &_task);
+	void WorkerLoop(int _worker);
+};
+
+#endif // _TASKSCHEDULER_H_
\ No newline at end of file
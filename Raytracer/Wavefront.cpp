@@ -0,0 +1,103 @@
+/// @file Wavefront.cpp
+/// @brief Stages of the wavefront pipeline, each one loop over a queue
+
+#include <utility>
+
+#include "Integrator.h"
+#include "Wavefront.h"
+
+void Wavefront::Trace(const FlatScene &_scene, Integrator &_integrator, bool _shadows, bool _sortRays, glm::vec3 *_colours, long long *_rays)
+{
+	bool cameraRays = true;		//Counted by the caller
+	while (m_rays.Size() > 0)
+	{
+		//Extend, camera rays come in tile order and are coherent already, bounces scatter so much that neighbours in the
+		//queue rarely share a node below the root
+		int numberOfRays = m_rays.Size();
+		if (_sortRays && !cameraRays)
+		{
+			m_sorter.Sort(m_rays.m_originX.data(), m_rays.m_originY.data(), m_rays.m_originZ.data(), m_rays.m_directionX.data(), m_rays.m_directionY.data(), m_rays.m_directionZ.data(), numberOfRays);
+			for (int k = 0; k < numberOfRays; ++k)
+			{
+				int r = m_sorter.m_order[k];
+				_scene.Intersection(&m_rays.m_hits[r], m_rays.Origin(r), m_rays.Direction(r));
+			}
+		}
+		else
+		{
+			for (int r = 0; r < numberOfRays; ++r)
+			{
+				_scene.Intersection(&m_rays.m_hits[r], m_rays.Origin(r), m_rays.Direction(r));
+			}
+		}
+		if (!cameraRays)
+		{
+			*_rays += numberOfRays;
+		}
+		cameraRays = false;
+
+		//Shade
+		m_bounces.Clear();
+		m_shadowRays.Clear();
+		for (int r = 0; r < numberOfRays; ++r)
+		{
+			_integrator.Shade(m_rays.Ray(r), m_rays.m_hits[r], m_bounces, m_shadowRays, _colours);
+		}
+
+		//Connect
+		if (_sortRays)
+		{
+			ConnectSorted(_scene, _shadows, _colours, _rays);
+		}
+		else
+		{
+			Connect(_scene, m_shadowRays, _shadows, _colours, _rays);
+		}
+
+		std::swap(m_rays, m_bounces);
+	}
+}
+
+void Wavefront::Connect(const FlatScene &_scene, const ShadowQueue &_shadowRays, bool _shadows, glm::vec3 *_colours, long long *_rays)
+{
+	int numberOfRays = _shadowRays.Size();
+	for (int s = 0; s < numberOfRays; ++s)
+	{
+		if (_shadows && _scene.Occluded(_shadowRays.Origin(s), _shadowRays.Direction(s), _shadowRays.m_maxT[s]))
+		{
+			continue;
+		}
+		_colours[_shadowRays.m_pixel[s]] += _shadowRays.Contribution(s);
+	}
+	if (_shadows)
+	{
+		*_rays += numberOfRays;
+	}
+}
+
+void Wavefront::ConnectSorted(const FlatScene &_scene, bool _shadows, glm::vec3 *_colours, long long *_rays)
+{
+	int numberOfRays = m_shadowRays.Size();
+	if (!_shadows)
+	{
+		Connect(_scene, m_shadowRays, _shadows, _colours, _rays);
+		return;
+	}
+
+	//Tested in sorted order, added in queue order
+	m_sorter.Sort(m_shadowRays.m_originX.data(), m_shadowRays.m_originY.data(), m_shadowRays.m_originZ.data(), m_shadowRays.m_directionX.data(), m_shadowRays.m_directionY.data(), m_shadowRays.m_directionZ.data(), numberOfRays);
+	m_visible.resize(numberOfRays);
+	for (int k = 0; k < numberOfRays; ++k)
+	{
+		int s = m_sorter.m_order[k];
+		m_visible[s] = !_scene.Occluded(m_shadowRays.Origin(s), m_shadowRays.Direction(s), m_shadowRays.m_maxT[s]);
+	}
+	for (int s = 0; s < numberOfRays; ++s)
+	{
+		if (m_visible[s])
+		{
+			_colours[m_shadowRays.m_pixel[s]] += m_shadowRays.Contribution(s);
+		}
+	}
+	*_rays += numberOfRays;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+/// \file Wavefront.h
+/// \brief traces a batch of camera rays a stage at a time - extend, shade, connect - rather than one path at a time
+/// \author Josh Bailey
+
+#ifndef _WAVEFRONT_H_
+#define _WAVEFRONT_H_
+
+//File includes
+#include <vector>
+#include <glm.hpp>
+
+#include "FlatScene.h"
+#include "RayQueue.h"
+#include "RaySorter.h"
+
+class Integrator;
+
+//Each stage runs over every ray of the batch before the next starts, so one stage's code and data stay in cache and
+//its loop has nothing else in it. Rays are queued in whatever order the stage before produced them, sorting traces
+//them in RaySorter's order instead while leaving the queues, and so the order colours are added in, untouched.
+class Wavefront
+{
+public:
+	//Variables
+	RayQueue m_rays;		//Generate stage, filled by the caller before Trace()
+
+	//Functions
+	//Until every path has ended: extend (closest hit of each queued ray), shade (the integrator adds what it found and
+	//queues shadow rays and bounces), connect (shadow rays that reach their light add their contribution)
+	void Trace(const FlatScene &_scene, Integrator &_integrator, bool _shadows, bool _sortRays, glm::vec3 *_colours, long long *_rays);
+	//Connect stage on its own, for integrators tracing one path at a time with the same shading code
+	static void Connect(const FlatScene &_scene, const ShadowQueue &_shadowRays, bool _shadows, glm::vec3 *_colours, long long *_rays);
+
+private:
+	//Variables
+	RayQueue m_bounces;		//Rays the shade stage queued for the next extend
+	ShadowQueue m_shadowRays;
+	RaySorter m_sorter;
+	std::vector<char> m_visible;	//Of each shadow ray, when they are tested out of order
+
+	//Functions
+	void ConnectSorted(const FlatScene &_scene, bool _shadows, glm::vec3 *_colours, long long *_rays);
+};
+
+#endif // _WAVEFRONT_H_
\ No newline at end of file
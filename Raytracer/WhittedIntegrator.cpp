@@ -0,0 +1,221 @@
+/// @file WhittedIntegrator.cpp
+/// @brief Phong shading from every light, with reflected and refracted rays kept on a stack rather than recursed into
+
+#include "WhittedIntegrator.h"
+
+//Phong term (- ambient) of one light
+static glm::vec3 Phong(const Material &_material, glm::vec3 _normal, glm::vec3 _towardsViewer, glm::vec3 _rayOfLight, glm::vec3 _intensity)
+{
+	//Diffuse
+	glm::vec3 diffuse = _material.m_diffuse * _intensity * glm::max(0.0f, glm::dot(_rayOfLight, _normal));
+
+	//Specular
+	glm::vec3 reflection = glm::normalize(2 * (glm::dot(_rayOfLight, _normal)) * _normal - _rayOfLight);
+	float calculateMaximum = glm::max(0.0f, glm::dot(reflection, _towardsViewer));
+	glm::vec3 specular = _material.m_specular * _intensity * glm::pow(calculateMaximum, (float)_material.m_shine);
+
+	return diffuse + specular;
+}
+
+WhittedIntegrator::WhittedIntegrator(const FlatScene &_scene, const SceneDescription &_description, const RenderSettings &_settings) :
+	Integrator(_scene, _description, _settings)
+{
+}
+
+glm::vec3 WhittedIntegrator::Radiance(const HitRecord &_hit, glm::vec3 _originOfRay, glm::vec3 _directionOfRay, int _pixel, int _sample, long long *_rays)
+{
+	//Local shading only, as the original renderer
+	int maxDepth = m_settings.MaxDepth();
+	if (maxDepth == 0)
+	{
+		return _hit.Hit() ? Shade(_hit, _originOfRay, _directionOfRay, _rays) : glm::vec3(1, 1, 1);
+	}
+
+	//Rays still to trace wait here rather than on the call stack, one per thread so its size is fixed whatever the scene
+	static thread_local RayStack stack;
+	stack.Clear();
+
+	PendingRay ray;
+	ray.m_origin = _originOfRay;
+	ray.m_direction = _directionOfRay;
+	ray.m_weight = glm::vec3(1, 1, 1);
+	ray.m_depth = 0;
+	ray.m_random = Random(_pixel, _sample);	//Russian roulette
+	HitRecord hit = _hit;
+	glm::vec3 colour = glm::vec3(0, 0, 0);
+
+	while (true)
+	{
+		if (hit.Hit())
+		{
+			//Whatever isn't passed through is shaded as before
+			const Material &material = m_scene.MaterialOf(hit);
+			float opacity = 1.0f - material.m_transparency;
+			if (opacity > 0.0f)
+			{
+				colour += ray.m_weight * opacity * Shade(hit, ray.m_origin, ray.m_direction, _rays);
+			}
+			if (ray.m_depth < maxDepth && material.Scatters())
+			{
+				PendingRay scattered[2];
+				int numberOfScattered = Scatter(hit, ray, scattered);
+				for (int k = 0; k < numberOfScattered; ++k)
+				{
+					stack.Push(scattered[k]);
+				}
+			}
+		}
+		else
+		{
+			colour += ray.m_weight;	//White background
+		}
+
+		if (stack.Empty())
+		{
+			return colour;
+		}
+		ray = stack.Pop();
+		hit = HitRecord();
+		m_scene.Intersection(&hit, ray.m_origin, ray.m_direction);
+		++*_rays;
+	}
+}
+
+glm::vec3 WhittedIntegrator::Shade(const HitRecord &_hit, glm::vec3 _originOfRay, glm::vec3 _directionOfRay, long long *_shadowRays)
+{
+	glm::vec3 p0 = _originOfRay + (_hit.m_t * _directionOfRay);
+
+	//Surface that was hit, looked up once per pixel
+	const Material &material = m_scene.MaterialOf(_hit);
+	glm::vec3 normal = glm::normalize(m_scene.Normal(_hit, p0));
+	glm::vec3 towardsViewer = glm::normalize(_originOfRay - p0);
+
+	//Each light adds its own phong term (- ambient), unless the surface is in its shadow
+	glm::vec3 colour = glm::vec3(0, 0, 0);
+	for (const Light &light : m_description.m_lights)
+	{
+		glm::vec3 rayOfLight = glm::normalize(light.m_position - p0);	//Point light in the correct direction
+
+		//Shadow
+		if (m_settings.Shadows())
+		{
+			//Facing away from the light, the surface shadows itself and no ray is needed
+			float facing = glm::dot(rayOfLight, normal);
+			if (facing <= 0.0f)
+			{
+				continue;
+			}
+
+			//Start just off the surface on the light's side so the ray can't hit the surface it left
+			const float shadowBias = 1e-3f;
+			glm::vec3 shadowOrigin = p0 + normal * shadowBias;
+			float distanceToLight = glm::length(light.m_position - shadowOrigin);
+			++*_shadowRays;
+			if (m_scene.Occluded(shadowOrigin, (light.m_position - shadowOrigin) / distanceToLight, distanceToLight))
+			{
+				continue;
+			}
+		}
+
+		colour += Phong(material, normal, towardsViewer, rayOfLight, light.m_intensity);
+	}
+
+	//Pixel colour is the combination of diffuse and specular lighting
+	return colour;
+}
+
+void WhittedIntegrator::Shade(const QueuedRay &_ray, const HitRecord &_hit, RayQueue &_bounces, ShadowQueue &_shadowRays, glm::vec3 *_colours)
+{
+	if (!_hit.Hit())
+	{
+		_colours[_ray.m_pixel] += _ray.m_weight;	//White background
+		return;
+	}
+
+	const Material &material = m_scene.MaterialOf(_hit);
+	glm::vec3 p0 = _ray.m_origin + (_hit.m_t * _ray.m_direction);
+
+	//As Shade(), each light's term waiting on its shadow ray in the connect stage
+	float opacity = 1.0f - material.m_transparency;
+	if (opacity > 0.0f)
+	{
+		glm::vec3 normal = glm::normalize(m_scene.Normal(_hit, p0));
+		glm::vec3 towardsViewer = glm::normalize(_ray.m_origin - p0);
+		const float shadowBias = 1e-3f;
+		glm::vec3 shadowOrigin = p0 + normal * shadowBias;
+		for (const Light &light : m_description.m_lights)
+		{
+			glm::vec3 rayOfLight = glm::normalize(light.m_position - p0);
+			if (m_settings.Shadows() && glm::dot(rayOfLight, normal) <= 0.0f)
+			{
+				continue;
+			}
+			float distanceToLight = glm::length(light.m_position - shadowOrigin);
+			glm::vec3 contribution = _ray.m_weight * (opacity * Phong(material, normal, towardsViewer, rayOfLight, light.m_intensity));
+			_shadowRays.Push(shadowOrigin, (light.m_position - shadowOrigin) / distanceToLight, distanceToLight, contribution, _ray.m_pixel);
+		}
+	}
+
+	if (_ray.m_depth < m_settings.MaxDepth() && material.Scatters())
+	{
+		PendingRay ray;
+		ray.m_origin = _ray.m_origin;
+		ray.m_direction = _ray.m_direction;
+		ray.m_weight = _ray.m_weight;
+		ray.m_depth = _ray.m_depth;
+		ray.m_random = _ray.m_random;
+		PendingRay scattered[2];
+		int numberOfScattered = Scatter(_hit, ray, scattered);
+		for (int k = 0; k < numberOfScattered; ++k)
+		{
+			QueuedRay bounce = _ray;
+			bounce.m_origin = scattered[k].m_origin;
+			bounce.m_direction = scattered[k].m_direction;
+			bounce.m_weight = scattered[k].m_weight;
+			bounce.m_depth = scattered[k].m_depth;
+			bounce.m_random = scattered[k].m_random;
+			_bounces.Push(bounce);
+		}
+	}
+}
+
+int WhittedIntegrator::Scatter(const HitRecord &_hit, const PendingRay &_ray, PendingRay *_scattered)
+{
+	PCG32 random = _ray.m_random;
+	const Material &material = m_scene.MaterialOf(_hit);
+	glm::vec3 p0 = _ray.m_origin + (_hit.m_t * _ray.m_direction);
+	SurfaceSplit split = Split(material, _ray.m_direction, glm::normalize(m_scene.Normal(_hit, p0)));
+
+	//Start just off the surface on the side each ray leaves from, as shadow rays do
+	const float bias = 1e-3f;
+	int numberOfScattered = 0;
+	glm::vec3 reflectedWeight = _ray.m_weight * material.m_specular * split.m_fresnel;
+	if (Survives(&reflectedWeight, random))
+	{
+		PendingRay &reflected = _scattered[numberOfScattered++];
+		reflected.m_origin = p0 + split.m_normal * bias;
+		reflected.m_direction = split.m_reflected;
+		reflected.m_weight = reflectedWeight;
+		reflected.m_depth = _ray.m_depth + 1;
+	}
+	if (split.m_refracts)
+	{
+		glm::vec3 refractedWeight = _ray.m_weight * (material.m_transparency * (1.0f - split.m_fresnel));
+		if (Survives(&refractedWeight, random))
+		{
+			PendingRay &refracted = _scattered[numberOfScattered++];
+			refracted.m_origin = p0 - split.m_normal * bias;
+			refracted.m_direction = split.m_refracted;
+			refracted.m_weight = refractedWeight;
+			refracted.m_depth = _ray.m_depth + 1;
+		}
+	}
+
+	//Each ray carries on from where the draws left off, a step apart so the two don't make the same draws from here on
+	for (int k = 0; k < numberOfScattered; ++k)
+	{
+		_scattered[k].m_random = random;
+		random.Next();
+	}
+	return numberOfScattered;
+}
\ No newline at end of file
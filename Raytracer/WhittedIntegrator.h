@@ -0,0 +1,26 @@
+/// \file WhittedIntegrator.h
+/// \brief phong shading at every hit, plus mirror reflection and refraction up to the depth asked for, the fast preview
+/// \author Josh Bailey
+
+#ifndef _WHITTEDINTEGRATOR_H_
+#define _WHITTEDINTEGRATOR_H_
+
+//File includes
+#include "Integrator.h"
+#include "RayStack.h"
+
+class WhittedIntegrator : public Integrator
+{
+public:
+	//Functions
+	WhittedIntegrator(const FlatScene &_scene, const SceneDescription &_description, const RenderSettings &_settings);
+	glm::vec3 Radiance(const HitRecord &_hit, glm::vec3 _originOfRay, glm::vec3 _directionOfRay, int _pixel, int _sample, long long *_rays) override;
+	void Shade(const QueuedRay &_ray, const HitRecord &_hit, RayQueue &_bounces, ShadowQueue &_shadowRays, glm::vec3 *_colours) override;
+
+private:
+	//Functions
+	glm::vec3 Shade(const HitRecord &_hit, glm::vec3 _originOfRay, glm::vec3 _directionOfRay, long long *_shadowRays);
+	int Scatter(const HitRecord &_hit, const PendingRay &_ray, PendingRay *_scattered);	//The reflected and refracted rays leaving _hit that survive roulette, returns how many
+};
+
+#endif // _WHITTEDINTEGRATOR_H_
\ No newline at end of file
@@ -0,0 +1,124 @@
+/// @file WideBVH.cpp
+/// @brief Collapses the binary BVH into wide nodes, opening the largest interior child until each node is full
+
+#include <cmath>
+
+#include "WideBVH.h"
+
+//A node with every slot empty, the count of -1 keeps rays out and the bounds are an empty box as AABB() starts with
+static WideBVHNode EmptyNode()
+{
+	WideBVHNode node;
+	for (int k = 0; k < WIDEBVH_WIDTH; ++k)
+	{
+		node.m_minX[k] = INFINITY;
+		node.m_minY[k] = INFINITY;
+		node.m_minZ[k] = INFINITY;
+		node.m_maxX[k] = -INFINITY;
+		node.m_maxY[k] = -INFINITY;
+		node.m_maxZ[k] = -INFINITY;
+		node.m_child[k] = -1;
+		node.m_count[k] = -1;
+	}
+	return node;
+}
+
+//Copies a binary node into slot _slot, as a leaf if it is one
+static void SetSlot(WideBVHNode &_node, int _slot, const BVHNode &_child)
+{
+	_node.m_minX[_slot] = _child.m_bounds.m_min.x;
+	_node.m_minY[_slot] = _child.m_bounds.m_min.y;
+	_node.m_minZ[_slot] = _child.m_bounds.m_min.z;
+	_node.m_maxX[_slot] = _child.m_bounds.m_max.x;
+	_node.m_maxY[_slot] = _child.m_bounds.m_max.y;
+	_node.m_maxZ[_slot] = _child.m_bounds.m_max.z;
+	_node.m_child[_slot] = _child.m_leftOrFirst;
+	_node.m_count[_slot] = _child.m_count;
+}
+
+WideBVH::WideBVH()
+{
+}
+
+void WideBVH::Clear()
+{
+	std::vector<WideBVHNode>().swap(m_nodes);
+}
+
+bool WideBVH::Empty() const
+{
+	return m_nodes.empty();
+}
+
+void WideBVH::Build(const BVH &_bvh)
+{
+	Clear();
+	if (_bvh.Empty())
+	{
+		return;
+	}
+
+	//Each wide node stands for at least one binary interior node, about half of the binary nodes
+	m_nodes.reserve(_bvh.m_nodes.size() / 2 + 1);
+	m_nodes.push_back(EmptyNode());
+
+	//A scene small enough to be one leaf still gets a root for the traversal to start from
+	if (_bvh.m_nodes[0].m_count > 0)
+	{
+		SetSlot(m_nodes[0], 0, _bvh.m_nodes[0]);
+		return;
+	}
+	Collapse(_bvh, 0, 0);
+}
+
+int WideBVH::OpenChildren(const BVH &_bvh, int _binaryNode, int _width, int *_children)
+{
+	int numberOfChildren = 2;
+	_children[0] = _bvh.m_nodes[_binaryNode].m_leftOrFirst;
+	_children[1] = _children[0] + 1;
+
+	while (numberOfChildren < _width)
+	{
+		int largest = -1;
+		float largestArea = -1.0f;
+		for (int k = 0; k < numberOfChildren; ++k)
+		{
+			const BVHNode &child = _bvh.m_nodes[_children[k]];
+			if (child.m_count == 0 && child.m_bounds.SurfaceArea() > largestArea)
+			{
+				largest = k;
+				largestArea = child.m_bounds.SurfaceArea();
+			}
+		}
+		if (largest < 0)
+		{
+			break;
+		}
+
+		int left = _bvh.m_nodes[_children[largest]].m_leftOrFirst;
+		_children[largest] = left;
+		_children[numberOfChildren] = left + 1;
+		++numberOfChildren;
+	}
+	return numberOfChildren;
+}
+
+void WideBVH::Collapse(const BVH &_bvh, int _binaryNode, int _wideNode)
+{
+	int children[WIDEBVH_WIDTH];
+	int numberOfChildren = OpenChildren(_bvh, _binaryNode, WIDEBVH_WIDTH, children);
+
+	for (int k = 0; k < numberOfChildren; ++k)
+	{
+		const BVHNode &child = _bvh.m_nodes[children[k]];
+		SetSlot(m_nodes[_wideNode], k, child);
+		if (child.m_count == 0)
+		{
+			//Indices rather than references, m_nodes may grow below
+			int wideChild = (int)m_nodes.size();
+			m_nodes[_wideNode].m_child[k] = wideChild;
+			m_nodes.push_back(EmptyNode());
+			Collapse(_bvh, children[k], wideChild);
+		}
+	}
+}
\ No newline at end of file
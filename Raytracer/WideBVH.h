@@ -0,0 +1,254 @@
+/// \file WideBVH.h
+/// \brief the binary BVH collapsed into nodes of 4 (SSE) or 8 (AVX) children, each node's children tested against a ray at once
+/// \author Josh Bailey
+
+#ifndef _WIDEBVH_H_
+#define _WIDEBVH_H_
+
+//File includes
+#include <vector>
+#include <glm.hpp>
+
+#include "BVH.h"
+#include "SphereSet.h"
+
+#if defined(SPHERESET_AVX)
+#include <immintrin.h>
+#elif defined(SPHERESET_SSE)
+#include <emmintrin.h>
+#endif
+
+//Children per node, as many as one instruction can test, 4 without SIMD still halves the levels of a binary tree
+#if defined(SPHERESET_AVX)
+#define WIDEBVH_WIDTH 8
+#else
+#define WIDEBVH_WIDTH 4
+#endif
+
+//128 bytes (SSE) or 256 bytes (AVX), child bounds a component per array so they load straight into registers
+struct WideBVHNode
+{
+	float m_minX[WIDEBVH_WIDTH];
+	float m_minY[WIDEBVH_WIDTH];
+	float m_minZ[WIDEBVH_WIDTH];
+	float m_maxX[WIDEBVH_WIDTH];
+	float m_maxY[WIDEBVH_WIDTH];
+	float m_maxZ[WIDEBVH_WIDTH];
+	int m_child[WIDEBVH_WIDTH];		//Interior child: index of its node, leaf: first entry in the BVH's m_primitives
+	int m_count[WIDEBVH_WIDTH];		//Number of primitives in a leaf, 0 for interior children, -1 for empty slots, never entered
+
+	//Bit k set if the ray enters child k closer than _maxT, with the distance it enters in _tNear[k], empty slots
+	//are masked off by their count of -1, as no bounds fail the slab test for every ray
+	int Intersection(float *_tNear, const glm::vec3 &_originOfRay, const glm::vec3 &_inverseDirectionOfRay, float _maxT) const;
+};
+
+//A child waiting to be visited, the distance it is entered lets it be skipped once something closer is hit
+struct WideBVHEntry
+{
+	int m_child;
+	int m_count;
+	float m_t;
+};
+
+class WideBVH
+{
+public:
+	//Variables
+	std::vector<WideBVHNode> m_nodes;	//Root first, leaves are slots in their parent rather than nodes of their own
+
+	//Functions
+	WideBVH();
+	//Leaves keep their ranges of _bvh.m_primitives, so the callbacks given to the traversals index it as before
+	void Build(const BVH &_bvh);
+	void Clear();
+	bool Empty() const;
+
+	//Same leaf callbacks as BVH::Intersection and BVH::Occluded
+	template <typename IntersectLeaf>
+	bool Intersection(float *_minT, int *_hitPrimitive, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, IntersectLeaf _intersectLeaf) const;
+	template <typename OccludedLeaf>
+	bool Occluded(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT, OccludedLeaf _occludedLeaf) const;
+
+	//Fills _children with up to _width binary nodes under interior node _binaryNode, opening up the interior child with
+	//the largest surface area, the one most rays reach, until there are _width or only leaves are left, returns how many
+	static int OpenChildren(const BVH &_bvh, int _binaryNode, int _width, int *_children);
+	//Pushes the children of any wide node in _mask furthest first, so the nearest is popped next
+	template <typename Node>
+	static void Push(const Node &_node, int _mask, const float *_tNear, WideBVHEntry *_stack, int *_stackSize);
+
+private:
+	//Functions
+	void Collapse(const BVH &_bvh, int _binaryNode, int _wideNode);
+};
+
+//Each level pushes at most one child fewer than the width, as the nearest is popped straight away
+static const int wideBVHStackSize = bvhMaxDepth * (WIDEBVH_WIDTH - 1) + 1;
+
+inline int WideBVHNode::Intersection(float *_tNear, const glm::vec3 &_originOfRay, const glm::vec3 &_inverseDirectionOfRay, float _maxT) const
+{
+#if defined(SPHERESET_AVX)
+	//Same slab test as AABB::Intersection, a lane per child
+	__m256 originX = _mm256_set1_ps(_originOfRay.x);
+	__m256 originY = _mm256_set1_ps(_originOfRay.y);
+	__m256 originZ = _mm256_set1_ps(_originOfRay.z);
+	__m256 inverseX = _mm256_set1_ps(_inverseDirectionOfRay.x);
+	__m256 inverseY = _mm256_set1_ps(_inverseDirectionOfRay.y);
+	__m256 inverseZ = _mm256_set1_ps(_inverseDirectionOfRay.z);
+	__m256 t0x = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(m_minX), originX), inverseX);
+	__m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(m_maxX), originX), inverseX);
+	__m256 t0y = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(m_minY), originY), inverseY);
+	__m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(m_maxY), originY), inverseY);
+	__m256 t0z = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(m_minZ), originZ), inverseZ);
+	__m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(m_maxZ), originZ), inverseZ);
+	__m256 tEnter = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t0x, t1x), _mm256_min_ps(t0y, t1y)), _mm256_max_ps(_mm256_min_ps(t0z, t1z), _mm256_setzero_ps()));
+	__m256 tExit = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t0x, t1x), _mm256_max_ps(t0y, t1y)), _mm256_min_ps(_mm256_max_ps(t0z, t1z), _mm256_set1_ps(_maxT)));
+	_mm256_storeu_ps(_tNear, tEnter);
+	int empty = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_loadu_si256((const __m256i *)m_count)));	//Sign bits of the counts
+	return _mm256_movemask_ps(_mm256_cmp_ps(tEnter, tExit, _CMP_LE_OQ)) & ~empty;
+#elif defined(SPHERESET_SSE)
+	__m128 originX = _mm_set1_ps(_originOfRay.x);
+	__m128 originY = _mm_set1_ps(_originOfRay.y);
+	__m128 originZ = _mm_set1_ps(_originOfRay.z);
+	__m128 inverseX = _mm_set1_ps(_inverseDirectionOfRay.x);
+	__m128 inverseY = _mm_set1_ps(_inverseDirectionOfRay.y);
+	__m128 inverseZ = _mm_set1_ps(_inverseDirectionOfRay.z);
+	__m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(m_minX), originX), inverseX);
+	__m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(m_maxX), originX), inverseX);
+	__m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(m_minY), originY), inverseY);
+	__m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(m_maxY), originY), inverseY);
+	__m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(m_minZ), originZ), inverseZ);
+	__m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(m_maxZ), originZ), inverseZ);
+	__m128 tEnter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)), _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+	__m128 tExit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)), _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_set1_ps(_maxT)));
+	_mm_storeu_ps(_tNear, tEnter);
+	int empty = _mm_movemask_ps(_mm_castsi128_ps(_mm_loadu_si128((const __m128i *)m_count)));	//Sign bits of the counts
+	return _mm_movemask_ps(_mm_cmple_ps(tEnter, tExit)) & ~empty;
+#else
+	int mask = 0;
+	for (int k = 0; k < WIDEBVH_WIDTH; ++k)
+	{
+		AABB bounds(glm::vec3(m_minX[k], m_minY[k], m_minZ[k]), glm::vec3(m_maxX[k], m_maxY[k], m_maxZ[k]));
+		if (m_count[k] >= 0 && bounds.Intersection(&_tNear[k], _originOfRay, _inverseDirectionOfRay, _maxT))
+		{
+			mask |= 1 << k;
+		}
+	}
+	return mask;
+#endif
+}
+
+template <typename Node>
+void WideBVH::Push(const Node &_node, int _mask, const float *_tNear, WideBVHEntry *_stack, int *_stackSize)
+{
+	//Insertion sort of at most one entry per child, furthest at the bottom
+	const int width = (int)(sizeof(_node.m_child) / sizeof(_node.m_child[0]));
+	int first = *_stackSize;
+	for (int k = 0; k < width; ++k)
+	{
+		if ((_mask & (1 << k)) == 0)
+		{
+			continue;
+		}
+		int slot = *_stackSize;
+		while (slot > first && _stack[slot - 1].m_t < _tNear[k])
+		{
+			_stack[slot] = _stack[slot - 1];
+			--slot;
+		}
+		_stack[slot].m_child = _node.m_child[k];
+		_stack[slot].m_count = _node.m_count[k];
+		_stack[slot].m_t = _tNear[k];
+		++*_stackSize;
+	}
+}
+
+template <typename IntersectLeaf>
+bool WideBVH::Intersection(float *_minT, int *_hitPrimitive, const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, IntersectLeaf _intersectLeaf) const
+{
+	if (m_nodes.empty())
+	{
+		return false;
+	}
+
+	glm::vec3 inverseDirectionOfRay = 1.0f / _directionOfRay;
+	bool hit = false;
+	float tNear[WIDEBVH_WIDTH];
+
+	WideBVHEntry stack[wideBVHStackSize];
+	int stackSize = 0;
+	int node = 0;
+
+	while (true)
+	{
+		//Every child the ray reaches before the closest hit goes on the stack, nearest on top
+		int mask = m_nodes[node].Intersection(tNear, _originOfRay, inverseDirectionOfRay, *_minT);
+		Push(m_nodes[node], mask, tNear, stack, &stackSize);
+
+		//Leaves are intersected as they come off the stack, until an interior node is next or nothing is left,
+		//anything entered beyond the closest hit so far is dropped
+		while (true)
+		{
+			if (stackSize == 0)
+			{
+				return hit;
+			}
+			const WideBVHEntry &entry = stack[--stackSize];
+			if (entry.m_t > *_minT)
+			{
+				continue;
+			}
+			if (entry.m_count == 0)
+			{
+				node = entry.m_child;
+				break;
+			}
+			if (_intersectLeaf(entry.m_child, entry.m_count, _minT, _hitPrimitive))
+			{
+				hit = true;
+			}
+		}
+	}
+}
+
+template <typename OccludedLeaf>
+bool WideBVH::Occluded(const glm::vec3 &_originOfRay, const glm::vec3 &_directionOfRay, float _maxT, OccludedLeaf _occludedLeaf) const
+{
+	if (m_nodes.empty())
+	{
+		return false;
+	}
+
+	glm::vec3 inverseDirectionOfRay = 1.0f / _directionOfRay;
+	float tNear[WIDEBVH_WIDTH];
+
+	WideBVHEntry stack[wideBVHStackSize];
+	int stackSize = 0;
+	int node = 0;
+
+	while (true)
+	{
+		//Nearest first still pays off, an occluder close to the ray origin is found sooner
+		int mask = m_nodes[node].Intersection(tNear, _originOfRay, inverseDirectionOfRay, _maxT);
+		Push(m_nodes[node], mask, tNear, stack, &stackSize);
+
+		while (true)
+		{
+			if (stackSize == 0)
+			{
+				return false;
+			}
+			const WideBVHEntry &entry = stack[--stackSize];
+			if (entry.m_count == 0)
+			{
+				node = entry.m_child;
+				break;
+			}
+			if (_occludedLeaf(entry.m_child, entry.m_count))
+			{
+				return true;
+			}
+		}
+	}
+}
+
+#endif // _WIDEBVH_H_
\ No newline at end of file